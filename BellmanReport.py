@@ -179,29 +179,58 @@ class Category:
         self.category = category
         self.results = []
  
-def FillCategories(path):
-	
-	files = glob.glob(os.path.join(path, "*.out"))
-	g.show("Loading {0} files, please  wait...".format(str(len(files))))
+# Runs bellman -c on many files at once, which prints "file:" before the lines of each of
+# them. The files are given by name in path, and in batches, to stay within the command line
+# limit of Windows. Returns the keys and values printed for each file, by file name.
+CLASSIFY_BATCH = 500
 
-	cats = {}
-	idx = 0
+def Classify(path, files):
 	
-	for f in files:
+	exe = os.path.join(os.path.dirname(os.path.realpath('__file__')), "bellman.exe")
+	results = {}
+	
+	for i in xrange(0, len(files), CLASSIFY_BATCH):
 		
-		lines = subprocess.Popen([os.path.join(os.path.dirname(os.path.realpath('__file__')), "bellman.exe"), "-c", f], stdout=subprocess.PIPE,  shell=True).communicate()[0]
+		batch = [os.path.basename(f) for f in files[i:i + CLASSIFY_BATCH]]
+		lines = subprocess.Popen([exe, "-c"] + batch, stdout=subprocess.PIPE, cwd=path).communicate()[0]
 		lines = lines.split("\n")
-		d = {}
+		
+		# With a single file, bellman doesn't print "file:"
+		d = None
+		if len(batch) == 1:
+			d = results[batch[0]] = {}
+		
 		for l in lines:
 			idx = l.find(":")
 			if idx > 0:
 				key = l[:idx].strip()
 				val = l[idx+1:].strip()
+				if key == "file":
+					d = results[val] = {}
+					continue
+				if d is None:
+					continue
 				if d.has_key(key):
 					prev = d[key] + "\n"
 				else:
 					prev = ""
 				d[key] = prev + val
+	
+	return results
+
+def FillCategories(path):
+	
+	files = glob.glob(os.path.join(path, "*.out"))
+	g.show("Loading {0} files, please  wait...".format(str(len(files))))
+
+	cats = {}
+	idx = 0
+	
+	classified = Classify(path, files)
+	
+	for f in files:
+		
+		d = classified[os.path.basename(f)]
 		category = d["hash"]
 		
 		if not cats.has_key(category):
@@ -4,12 +4,24 @@
 #include <time.h>
 #include <assert.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
 #include "universe.h"
 #include "readwrite.h"
 #include "bitwise.h"
+#include "fixedcats.h"
+#include "resultstream.h"
 
-// REINTRODUCTION OF FIXED CATALYSTS
-// int ver_cats (generation *ge);
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#else
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#endif
 
 #define YES 1
 #define NO 0
@@ -39,6 +51,7 @@ static const char *PARM_ACCEPT2_ACT_INACT_GENS =	"accept-alt2-active-inactive-ge
 static const char *PARM_ACCEPT2_MIN_INACT_GENS =	"accept-alt2-min-inactive-gens";
 static const char *PARM_CONT_AFTER_ACCEPT =			"continue-after-accept";
 static const char *PARM_MAX_ADDED_STATIC_ON =		"max-added-static-oncells";
+static const char *PARM_ONCELL_DEEPENING =			"iterative-deepening-oncells";
 static const char *PARM_MAX_ACT_CELLS =				"max-active-cells";
 static const char *PARM_FILTER_MIN_ACT_CELLS =		"filter-below-min-active-cells";
 static const char *PARM_MAX_LOCAL_RECT_COMPL =		"max-local-rect-complexity";
@@ -48,6 +61,9 @@ static const char *PARM_MIN_RECT_SEPARATION_SQ =	"min-rect-separation-squared";
 static const char *PARM_MAX_GLOBAL_COMPL =			"max-global-complexity";
 static const char *PARM_NEW_RESULT_NAMING =			"new-result-naming";
 static const char *PARM_MAX_RESULTS =				"max-results";
+static const char *PARM_DEFER_SUBTREE_NODES =		"defer-subtree-nodes";
+static const char *PARM_DEFER_SUBTREE_LEVEL =		"defer-subtree-level";
+static const char *PARM_REVISIT_DEFERRED =			"revisit-deferred";
 
 static const char *PARM_SYM_HORZ_ODD =				"symmetry-horiz-odd";
 static const char *PARM_SYM_HORZ_EVEN =				"symmetry-horiz-even";
@@ -64,6 +80,7 @@ static universe *u_static, *u_evolving, *u_forbidden, *u_filter;
 #define MAX_MAX_LOCAL_RECTS 32
 #define MAX_MAX_UNMERGED_LOCAL_RECTS (4 * MAX_MAX_LOCAL_RECTS)
 #define MAX_LISTED_ACTIVATIONS 32
+#define MAX_DECIDED_CELLS 8192
 
 #define LOCAL_RECT_FREE_CELLS 4
 #define LOCAL_COMPL_OVERALL_FREE_CELLS 9
@@ -82,6 +99,7 @@ static universe *u_static, *u_evolving, *u_forbidden, *u_filter;
 #define DEF_MAX_ACT_CELLS 8
 #define DEF_MAX_LOCAL_RECTS 2
 #define DEF_MIN_RECT_SEPARATION_SQ 8
+#define DEF_DEFER_SUBTREE_LEVEL 8
 
 // Search parameters:
 // Note that if both max_last_act_gen and max_act_window_gens are expicitly set to a value,
@@ -100,6 +118,7 @@ static int accept2_act_inact_gens = PARM_NOT_SET;
 static int accept2_min_inact_gens = PARM_NOT_SET;
 static int cont_after_accept = PARM_NOT_SET;
 static int max_added_static_on = PARM_NOT_SET;
+static int oncell_deepening = PARM_NOT_SET;
 static int max_act_cells = PARM_NOT_SET;
 static int max_local_rect_compl = PARM_NOT_SET;
 static int max_overall_local_compl = PARM_NOT_SET;
@@ -108,6 +127,9 @@ static int min_rect_separation_sq = PARM_NOT_SET;
 static int max_global_compl = PARM_NOT_SET;
 static int new_result_naming = PARM_NOT_SET;
 static int max_results = PARM_NOT_SET;
+static int defer_subtree_nodes = PARM_NOT_SET;
+static int defer_subtree_level = PARM_NOT_SET;
+static int revisit_deferred = PARM_NOT_SET;
 
 // Symmetry constraints
 static enum {
@@ -126,15 +148,48 @@ static int solcount = 0;
 static int max_gens;
 static int current_single_gen = -1;
 
+// Results stream given with -o, or with -b for compact records, see add_stream_result
+static const char *results_stream_name = NULL;
+static int compact_results = NO;
+static FILE *results_stream = NULL, *results_index = NULL;
+
 
 // List of currently added static on-cells
 static int onlist_x [MAX_MAX_ADDED_STATIC_ON];
 static int onlist_y [MAX_MAX_ADDED_STATIC_ON];
 static int onlist_cnt = 0;
 
+// The most static on-cells that may currently be added. This is max_added_static_on,
+// or with iterative deepening the budget of the current pass. Solutions with no more
+// on-cells than reported_budget were already reported by an earlier pass.
+static int added_on_budget = PARM_DISABLED;
+static int reported_budget = -1;
+static uint64_t budget_cuts = 0;
+
+// Catalyst library, if one was given with -l. Static cells are then chosen by
+// placing whole catalysts instead of setting one cell On at a time.
+static catalyst *catalysts = NULL;
+static int n_catalysts = 0;
+
+// Static cells decided by bellman_choose_cells on the current search path, in the order they
+// were decided, as the tile in the evolving universe they were set in and the cell in that tile.
+// The cells of the latest decision start at decided_latest.
+static tile *decided_tile [MAX_DECIDED_CELLS];
+static int decided_x [MAX_DECIDED_CELLS];
+static int decided_y [MAX_DECIDED_CELLS];
+static cellvalue decided_v [MAX_DECIDED_CELLS];
+static int decided_cnt = 0;
+static int decided_latest = 0;
+static uint64_t decided_hash = 0;
+
 
 // Status update values and prune counters
 #define STATUS_UPDATE_INTERVAL 10.0
+#define STATUS_TICK_MS 100
+
+// Set by the status timer thread every STATUS_TICK_MS, so the search only looks at the clock then
+static int status_tick = NO;
+static int status_timer_started = NO;
 
 static time_t start_time;
 static time_t last_print_time = 0;
@@ -165,6 +220,74 @@ static uint64_t prune_too_compl_local_rect = 0;
 static uint64_t prune_too_compl_overall_locally = 0;
 static uint64_t prune_too_many_local_rects = 0;
 static uint64_t prune_too_compl_globally = 0;
+static uint64_t prune_nogood = 0;
+static uint64_t prune_transposition = 0;
+static uint64_t prune_deferred = 0;
+
+static uint64_t recurse_nodes = 0;
+static uint64_t tiles_evolved = 0;
+static uint64_t gens_evolved = 0;
+
+// Benchmark runs: the search stops after node_budget calls of bellman_recurse if it is set,
+// and bench_file_name gets a JSON record of the run, see write_bench_record
+static uint64_t node_budget = 0;
+static const char *bench_file_name = NULL;
+static uint64_t solution_checksum = 0;
+
+static uint32_t nogood_cnt = 0; // nogood ids start at 1, so 0 is an empty index entry
+static uint64_t nogood_lookups = 0;
+static uint64_t nogood_too_large = 0;
+
+// The counters a parallel worker adds to the totals when it is done
+static uint64_t *const worker_counters [] = {
+	&prune_unstable, &prune_stopped_adding_oncells, &prune_forbidden, &prune_solution, &prune_no_cont_found,
+	&prune_explicit_filter_prune, &prune_explicit_filter_filtered, &prune_filter_too_few_act_cells,
+	&prune_first_acty_too_early, &prune_no_acty_in_time, &prune_acty_too_late, &prune_acty_window_too_long,
+	&prune_cons_acty_too_long, &prune_too_many_added_static_on, &prune_too_many_act_cells,
+	&prune_too_compl_local_rect, &prune_too_compl_overall_locally, &prune_too_many_local_rects,
+	&prune_too_compl_globally, &prune_nogood, &prune_transposition, &prune_deferred,
+	&nogood_lookups, &nogood_too_large, &recurse_nodes, &tiles_evolved, &gens_evolved, &solution_checksum
+};
+
+#define N_WORKER_COUNTERS ((int) (sizeof worker_counters / sizeof worker_counters [0]))
+
+// Statistics file given with --stats-file, with a JSON object per status update
+static FILE *stats_file = NULL;
+
+static const struct {
+	const char *name;
+	const uint64_t *count;
+} stats_counters [] = {
+	{"prune_unstable", &prune_unstable},
+	{"prune_stopped_adding_oncells", &prune_stopped_adding_oncells},
+	{"prune_forbidden", &prune_forbidden},
+	{"prune_solution", &prune_solution},
+	{"prune_no_cont_found", &prune_no_cont_found},
+	{"prune_explicit_filter_prune", &prune_explicit_filter_prune},
+	{"prune_explicit_filter_filtered", &prune_explicit_filter_filtered},
+	{"prune_filter_too_few_act_cells", &prune_filter_too_few_act_cells},
+	{"prune_first_acty_too_early", &prune_first_acty_too_early},
+	{"prune_no_acty_in_time", &prune_no_acty_in_time},
+	{"prune_acty_too_late", &prune_acty_too_late},
+	{"prune_acty_window_too_long", &prune_acty_window_too_long},
+	{"prune_cons_acty_too_long", &prune_cons_acty_too_long},
+	{"prune_too_many_added_static_on", &prune_too_many_added_static_on},
+	{"prune_too_many_act_cells", &prune_too_many_act_cells},
+	{"prune_too_compl_local_rect", &prune_too_compl_local_rect},
+	{"prune_too_compl_overall_locally", &prune_too_compl_overall_locally},
+	{"prune_too_many_local_rects", &prune_too_many_local_rects},
+	{"prune_too_compl_globally", &prune_too_compl_globally},
+	{"prune_nogood", &prune_nogood},
+	{"prune_transposition", &prune_transposition},
+	{"prune_deferred", &prune_deferred},
+	{"nogood_lookups", &nogood_lookups},
+	{"nogood_too_large", &nogood_too_large}
+};
+
+#define N_STATS_COUNTERS ((int) (sizeof stats_counters / sizeof stats_counters [0]))
+
+// The strictly-gen-by-gen generation a parallel worker searches, or -1 if not a worker
+static int worker_gen = -1;
 
 
 static int assert_if_debug (int a)
@@ -209,6 +332,161 @@ static void print_elapsed (uint64_t elapsed)
 		printf ("%02d:%02d:%02d", hours, mins, secs);
 }
 
+// Peak memory use of this process in KB, or -1 if it isn't known
+static int64_t peak_memory_kb ()
+{
+#ifndef _WIN32
+	struct rusage ru;
+	
+	if (getrusage (RUSAGE_SELF, &ru) != 0)
+		return -1;
+#ifdef __APPLE__
+	return (int64_t) ru.ru_maxrss / 1024;
+#else
+	return (int64_t) ru.ru_maxrss;
+#endif
+#else
+	PROCESS_MEMORY_COUNTERS pmc;
+	
+	if (!GetProcessMemoryInfo (GetCurrentProcess (), &pmc, sizeof pmc))
+		return -1;
+	return (int64_t) (pmc.PeakWorkingSetSize / 1024);
+#endif
+}
+
+static uint64_t clock_ns ()
+{
+#ifdef _WIN32
+	LARGE_INTEGER count, freq;
+	QueryPerformanceCounter (&count);
+	QueryPerformanceFrequency (&freq);
+	return (uint64_t) ((double) count.QuadPart * 1e9 / (double) freq.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static void open_stats_file (const char *name)
+{
+	// Parallel workers write to the same file, so it is opened for appending and
+	// each record is written with one fflush
+	remove (name);
+	stats_file = fopen (name, "a");
+	if (!stats_file)
+	{
+		perror (name);
+		exit (-1);
+	}
+	
+	setvbuf (stats_file, NULL, _IOFBF, 16384);
+}
+
+// One line of JSON with the same numbers as the status output. total_prunes is the
+// sum of the prune counters that print_prune_counters shows.
+static void write_stats_record (time_t time_now, double total_time, double time_since_last_print, uint64_t total_prunes, int final)
+{
+	int i;
+	
+	fprintf (stats_file, "{\"time\": %" PRId64 ", \"elapsed\": %.0f, \"final\": %s", (int64_t) time_now, total_time, final ? "true" : "false");
+	fprintf (stats_file, ", \"worker_gen\": %d, \"current_single_gen\": %d", worker_gen, current_single_gen);
+	fprintf (stats_file, ", \"solcount\": %d, \"total_prunes\": %" PRIu64, solcount, total_prunes);
+	fprintf (stats_file, ", \"average_prunes_per_sec\": %.1f", total_time > 0.0 ? (double) total_prunes / total_time : 0.0);
+	fprintf (stats_file, ", \"current_prunes_per_sec\": %.1f", time_since_last_print > 0.0 ? (double) (total_prunes - last_total_prunes) / time_since_last_print : 0.0);
+	fprintf (stats_file, ", \"nogood_cnt\": %" PRIu32, nogood_cnt);
+	if (oncell_deepening)
+		fprintf (stats_file, ", \"added_on_budget\": %d", added_on_budget);
+	fprintf (stats_file, ", \"peak_memory_kb\": %" PRId64, peak_memory_kb ());
+	
+	for (i = 0; i < N_STATS_COUNTERS; i++)
+		fprintf (stats_file, ", \"%s\": %" PRIu64, stats_counters [i].name, *stats_counters [i].count);
+	
+	fprintf (stats_file, "}\n");
+	fflush (stats_file);
+}
+
+static void *status_timer_main (void *arg)
+{
+	(void) arg;
+	
+	for (;;)
+	{
+#ifdef _WIN32
+		Sleep (STATUS_TICK_MS);
+#else
+		struct timespec ts = {0, STATUS_TICK_MS * 1000000L};
+		nanosleep (&ts, NULL);
+#endif
+		__atomic_store_n (&status_tick, YES, __ATOMIC_RELAXED);
+	}
+	
+	return NULL;
+}
+
+// The thread isn't there after a fork, so a worker process starts its own
+static void start_status_timer ()
+{
+	pthread_t timer;
+	
+	if (status_timer_started)
+		return;
+	
+	if (pthread_create (&timer, NULL, status_timer_main, NULL) != 0)
+	{
+		fprintf (stderr, "Can't start the status timer thread\n");
+		exit (-1);
+	}
+	
+	pthread_detach (timer);
+	status_timer_started = YES;
+}
+
+static void write_json_string (FILE *f, const char *text)
+{
+	fputc ('"', f);
+	for (; *text; text++)
+	{
+		if (*text == '"' || *text == '\\')
+			fputc ('\\', f);
+		fputc (*text, f);
+	}
+	fputc ('"', f);
+}
+
+// One line of JSON for a benchmark run, added to bench_file_name. prunes is the sum of all
+// prune counters, and the checksum is the sum of snapshot_checksum of all solutions.
+static void write_bench_record (const char *input, uint64_t elapsed_ns)
+{
+	double seconds = (double) elapsed_ns / 1e9;
+	uint64_t prunes = 0;
+	int i;
+	
+	for (i = 0; i < N_STATS_COUNTERS; i++)
+		if (strncmp (stats_counters [i].name, "prune_", 6) == 0)
+			prunes += *stats_counters [i].count;
+	
+	FILE *f = fopen (bench_file_name, "a");
+	if (!f)
+	{
+		perror (bench_file_name);
+		return;
+	}
+	
+	fprintf (f, "{\"input\": ");
+	write_json_string (f, input);
+	fprintf (f, ", \"version\": \"%s\", \"tile_width\": %d", version_string, TILE_WIDTH);
+	fprintf (f, ", \"node_budget\": %" PRIu64 ", \"completed\": %s", node_budget, ((node_budget && recurse_nodes >= node_budget) || (max_results != PARM_DISABLED && solcount >= max_results)) ? "false" : "true");
+	fprintf (f, ", \"nodes\": %" PRIu64 ", \"seconds\": %.3f", recurse_nodes, seconds);
+	fprintf (f, ", \"nodes_per_sec\": %.1f", seconds > 0.0 ? (double) recurse_nodes / seconds : 0.0);
+	fprintf (f, ", \"prunes\": %" PRIu64 ", \"prunes_per_sec\": %.1f", prunes, seconds > 0.0 ? (double) prunes / seconds : 0.0);
+	fprintf (f, ", \"tiles_evolved\": %" PRIu64 ", \"tiles_per_node\": %.3f", tiles_evolved, recurse_nodes ? (double) tiles_evolved / (double) recurse_nodes : 0.0);
+	fprintf (f, ", \"gens_evolved\": %" PRIu64, gens_evolved);
+	fprintf (f, ", \"peak_memory_kb\": %" PRId64, peak_memory_kb ());
+	fprintf (f, ", \"solutions\": %d, \"checksum\": \"%016" PRIx64 "\"}\n", solcount, solution_checksum);
+	fclose (f);
+}
+
 static void print_prune_counters (int force)
 {
 	time_t time_now = time (NULL);
@@ -222,6 +500,8 @@ static void print_prune_counters (int force)
 	{
 		uint64_t total_prunes = 0;
 		
+		if (worker_gen >= 0)
+			printf("--- Generation %d:\n", worker_gen);
 		printf("  Reasons why search space was pruned:\n");
 		do_prune_line ("Static pattern is unstable", prune_unstable, &total_prunes);
 		do_prune_line ("Stopped adding new on-cells", prune_stopped_adding_oncells, &total_prunes);
@@ -248,7 +528,7 @@ static void print_prune_counters (int force)
 			do_prune_line ("Activity window lasted too long", prune_acty_window_too_long, &total_prunes);
 		if (max_cons_act_gens != PARM_DISABLED)
 			do_prune_line ("Too many active generations in a row", prune_cons_acty_too_long, &total_prunes);
-		if (max_added_static_on != PARM_DISABLED)
+		if (max_added_static_on != PARM_DISABLED || oncell_deepening)
 			do_prune_line ("Too many added static on-cells", prune_too_many_added_static_on, &total_prunes);
 		if (max_act_cells != PARM_DISABLED)
 			do_prune_line ("Too many active cells", prune_too_many_act_cells, &total_prunes);
@@ -260,12 +540,20 @@ static void print_prune_counters (int force)
 			do_prune_line ("Too many local rectangles", prune_too_many_local_rects, &total_prunes);
 		if (max_global_compl != PARM_DISABLED)
 			do_prune_line ("Too complex globally", prune_too_compl_globally, &total_prunes);
+		do_prune_line ("Matched a learned nogood", prune_nogood, &total_prunes);
+		if (n_catalysts > 0 || oncell_deepening)
+			do_prune_line ("Static pattern already searched", prune_transposition, &total_prunes);
+		if (defer_subtree_nodes != PARM_DISABLED)
+			do_prune_line ("Subtree deferred", prune_deferred, &total_prunes);
 		
 		if (uses_explicit_filter || filter_min_act_cells != PARM_DISABLED)
 			printf("  Solutions: %d (and %" PRIu64 " filtered), prunes: %" PRIu64 "\n", solcount, prune_explicit_filter_filtered + prune_filter_too_few_act_cells, total_prunes);
 		else
 			printf("  Solutions: %d, prunes: %" PRIu64 "\n", solcount, total_prunes);
 		
+		if (nogood_lookups > 0)
+			printf ("  Nogoods: %" PRIu32 " learned, %" PRIu64 " too large, hit rate %.3f%% of %" PRIu64 " lookups\n", nogood_cnt, nogood_too_large, 100.0 * (double) prune_nogood / (double) nogood_lookups, nogood_lookups);
+		
 		double total_time = difftime (time_now, start_time);
 		if (total_time > 0.0)
 		{
@@ -282,7 +570,10 @@ static void print_prune_counters (int force)
 			printf ("\n");
 		}
 		
-		if (strictly_gen_by_gen && max_first_act_gen > min_first_act_gen)
+		if (oncell_deepening)
+			printf ("  Searching with at most %d added static on-cells\n", added_on_budget);
+		
+		if (strictly_gen_by_gen && max_first_act_gen > min_first_act_gen && worker_gen < 0 && current_single_gen >= 0)
 		{
 			printf ("  Searching generation %d (%d of %d complete)\n", current_single_gen, current_single_gen - min_first_act_gen, max_first_act_gen - min_first_act_gen + 1);
 			printf ("  Time since start of current generation: ");
@@ -294,11 +585,200 @@ static void print_prune_counters (int force)
 		print_elapsed ((uint64_t) total_time);
 		printf ("\n");
 		
+		// A forced status is the last one of the process
+		if (stats_file)
+			write_stats_record (time_now, total_time, time_since_last_print, total_prunes, force);
+		
 		last_print_time = time_now;
 		last_total_prunes = total_prunes;
+		
+		// Parallel workers share stdout, so write each status as a whole
+		if (worker_gen >= 0)
+			fflush (stdout);
+	}
+}
+
+#ifdef PROFILE_SEARCH
+
+// Search profile.
+// Build with -DPROFILE_SEARCH to count each node of bellman_recurse at its depth (the number of
+// nested bellman_recurse calls) and at the last generation it checked, with its prunes, the tiles
+// and generations it evolved and its time. Only the work of the node itself is counted, not that
+// of the nodes below it. The table is written to profile.txt at exit.
+
+#define PROFILE_NODES 0
+#define PROFILE_TILES_EVOLVED 1
+#define PROFILE_GENS_EVOLVED 2
+#define PROFILE_NANOSECONDS 3
+#define PROFILE_FIRST_COUNTER 4
+#define PROFILE_N_VALUES (PROFILE_FIRST_COUNTER + N_STATS_COUNTERS)
+
+typedef struct {
+	uint64_t start [PROFILE_N_VALUES];
+	uint64_t below [PROFILE_N_VALUES];
+	int gen;
+} profile_frame;
+
+static profile_frame profile_stack [MAX_DECIDED_CELLS + 1];
+static int profile_depth = 0;
+static uint64_t *profile_table [MAX_DECIDED_CELLS + 1];
+static uint64_t profile_nodes = 0;
+
+#define PROFILE_GEN(g) (profile_stack [profile_depth - 1].gen = (g))
+
+static void profile_values (uint64_t *v)
+{
+	int i;
+	
+	v [PROFILE_NODES] = profile_nodes;
+	v [PROFILE_TILES_EVOLVED] = tiles_evolved;
+	v [PROFILE_GENS_EVOLVED] = gens_evolved;
+	v [PROFILE_NANOSECONDS] = clock_ns ();
+	for (i = 0; i < N_STATS_COUNTERS; i++)
+		v [PROFILE_FIRST_COUNTER + i] = *stats_counters [i].count;
+}
+
+static void profile_enter ()
+{
+	profile_frame *f = &profile_stack [profile_depth++];
+	
+	assert (profile_depth <= MAX_DECIDED_CELLS + 1);
+	profile_nodes++;
+	profile_values (f->start);
+	f->start [PROFILE_NODES]--;
+	memset (f->below, 0, sizeof f->below);
+	f->gen = -1;
+}
+
+static void profile_leave ()
+{
+	profile_frame *f = &profile_stack [--profile_depth];
+	uint64_t now [PROFILE_N_VALUES];
+	int i;
+	
+	// Row 0 is for nodes that were pruned before they got to any generation
+	if (!profile_table [profile_depth])
+	{
+		profile_table [profile_depth] = calloc ((size_t) (max_gens + 2) * PROFILE_N_VALUES, sizeof (uint64_t));
+		if (!profile_table [profile_depth])
+		{
+			fprintf (stderr, "Out of memory\n");
+			exit (-1);
+		}
+	}
+	
+	uint64_t *row = profile_table [profile_depth] + (size_t) (f->gen + 1) * PROFILE_N_VALUES;
+	
+	profile_values (now);
+	for (i = 0; i < PROFILE_N_VALUES; i++)
+	{
+		uint64_t total = now [i] - f->start [i];
+		row [i] += total - f->below [i];
+		if (profile_depth > 0)
+			profile_stack [profile_depth - 1].below [i] += total;
+	}
+}
+
+static void profile_print_row (FILE *f, const char *depth, const char *gen, const uint64_t *v)
+{
+	int i;
+	
+	fprintf (f, "%6s %4s %12" PRIu64 " %12.3f %12" PRIu64 " %10" PRIu64, depth, gen, v [PROFILE_NODES], (double) v [PROFILE_NANOSECONDS] / 1e6, v [PROFILE_TILES_EVOLVED], v [PROFILE_GENS_EVOLVED]);
+	for (i = 0; i < N_STATS_COUNTERS; i++)
+		fprintf (f, " %*" PRIu64, (int) strlen (stats_counters [i].name), v [PROFILE_FIRST_COUNTER + i]);
+	fprintf (f, "\n");
+}
+
+static void profile_print_header (FILE *f)
+{
+	int i;
+	
+	fprintf (f, "%6s %4s %12s %12s %12s %10s", "depth", "gen", "nodes", "ms", "tiles", "gens");
+	for (i = 0; i < N_STATS_COUNTERS; i++)
+		fprintf (f, " %s", stats_counters [i].name);
+	fprintf (f, "\n");
+}
+
+static void profile_add (uint64_t *sum, const uint64_t *v)
+{
+	int i;
+	for (i = 0; i < PROFILE_N_VALUES; i++)
+		sum [i] += v [i];
+}
+
+// The whole table, then the sums by depth and by generation
+static void write_profile (const char *name)
+{
+	uint64_t *by_gen = calloc ((size_t) (max_gens + 2) * PROFILE_N_VALUES, sizeof (uint64_t));
+	uint64_t by_depth [PROFILE_N_VALUES];
+	char depth_text [16], gen_text [16];
+	int depth, g;
+	
+	FILE *f = fopen (name, "w");
+	if (!f || !by_gen)
+	{
+		perror (name);
+		free (by_gen);
+		return;
+	}
+	
+	fprintf (f, "# Search profile by depth and generation, gen - is before any generation was checked\n");
+	profile_print_header (f);
+	for (depth = 0; depth <= MAX_DECIDED_CELLS; depth++)
+		if (profile_table [depth])
+			for (g = -1; g <= max_gens; g++)
+			{
+				const uint64_t *v = profile_table [depth] + (size_t) (g + 1) * PROFILE_N_VALUES;
+				if (v [PROFILE_NODES] == 0)
+					continue;
+				
+				sprintf (depth_text, "%d", depth);
+				if (g < 0)
+					sprintf (gen_text, "-");
+				else
+					sprintf (gen_text, "%d", g);
+				profile_print_row (f, depth_text, gen_text, v);
+				profile_add (by_gen + (size_t) (g + 1) * PROFILE_N_VALUES, v);
+			}
+	
+	fprintf (f, "\n# By depth\n");
+	profile_print_header (f);
+	for (depth = 0; depth <= MAX_DECIDED_CELLS; depth++)
+		if (profile_table [depth])
+		{
+			memset (by_depth, 0, sizeof by_depth);
+			for (g = -1; g <= max_gens; g++)
+				profile_add (by_depth, profile_table [depth] + (size_t) (g + 1) * PROFILE_N_VALUES);
+			sprintf (depth_text, "%d", depth);
+			profile_print_row (f, depth_text, "all", by_depth);
+		}
+	
+	fprintf (f, "\n# By generation\n");
+	profile_print_header (f);
+	for (g = -1; g <= max_gens; g++)
+	{
+		const uint64_t *v = by_gen + (size_t) (g + 1) * PROFILE_N_VALUES;
+		if (v [PROFILE_NODES] == 0)
+			continue;
+		
+		if (g < 0)
+			sprintf (gen_text, "-");
+		else
+			sprintf (gen_text, "%d", g);
+		profile_print_row (f, "all", gen_text, v);
 	}
+	
+	fclose (f);
+	free (by_gen);
+	printf ("--- Search profile written to %s\n", name);
 }
 
+#else
+
+#define PROFILE_GEN(g)
+
+#endif
+
 
 static void read_cb(void *u_, char area, int gen, int x, int y, char c) {
 	cellvalue vs = OFF, ve = OFF, vf = OFF;
@@ -408,6 +888,7 @@ static void read_param_cb(void *u_, const char *param, const char *value) {
 	match |= match_parameter (PARM_ACCEPT2_MIN_INACT_GENS, param, value, 1, 2047, &accept2_min_inact_gens);
 	match |= match_parameter (PARM_CONT_AFTER_ACCEPT, param, value, 0, 1, &cont_after_accept);
 	match |= match_parameter (PARM_MAX_ADDED_STATIC_ON, param, value, 0, MAX_MAX_ADDED_STATIC_ON, &max_added_static_on);
+	match |= match_parameter (PARM_ONCELL_DEEPENING, param, value, 0, 1, &oncell_deepening);
 	match |= match_parameter (PARM_MAX_ACT_CELLS, param, value, 0, 2047, &max_act_cells);
 	match |= match_parameter (PARM_FILTER_MIN_ACT_CELLS, param, value, 1, 2047, &filter_min_act_cells);
 	match |= match_parameter (PARM_MAX_LOCAL_RECT_COMPL, param, value, 0, 2047, &max_local_rect_compl);
@@ -417,6 +898,9 @@ static void read_param_cb(void *u_, const char *param, const char *value) {
 	match |= match_parameter (PARM_MAX_GLOBAL_COMPL, param, value, 0, 2047, &max_global_compl);
 	match |= match_parameter (PARM_NEW_RESULT_NAMING, param, value, 0, 1, &new_result_naming);
 	match |= match_parameter (PARM_MAX_RESULTS, param, value, 0, 1048575, &max_results);
+	match |= match_parameter (PARM_DEFER_SUBTREE_NODES, param, value, 1, INT_MAX, &defer_subtree_nodes);
+	match |= match_parameter (PARM_DEFER_SUBTREE_LEVEL, param, value, 1, MAX_DECIDED_CELLS, &defer_subtree_level);
+	match |= match_parameter (PARM_REVISIT_DEFERRED, param, value, 0, 1, &revisit_deferred);
 	
 	if(!strcmp(param, PARM_SYM_HORZ_ODD)) {
 		coord = strtol(value, NULL, 10);
@@ -563,6 +1047,9 @@ static int verify_and_fix_parameters ()
 	if (max_added_static_on == PARM_NOT_SET)
 		max_added_static_on = PARM_DISABLED;
 	
+	if (oncell_deepening == PARM_NOT_SET || oncell_deepening == PARM_DISABLED)
+		oncell_deepening = 0;
+	
 	if (max_act_cells == PARM_NOT_SET)
 		max_act_cells = DEF_MAX_ACT_CELLS;
 	
@@ -607,11 +1094,99 @@ static int verify_and_fix_parameters ()
 	if (max_results == PARM_NOT_SET)
 		max_results = PARM_DISABLED;
 	
+	if (defer_subtree_nodes == PARM_NOT_SET)
+		defer_subtree_nodes = PARM_DISABLED;
+	
+	if (defer_subtree_level == PARM_NOT_SET || defer_subtree_level == PARM_DISABLED)
+		defer_subtree_level = DEF_DEFER_SUBTREE_LEVEL;
+	
+	if (revisit_deferred == PARM_NOT_SET || revisit_deferred == PARM_DISABLED)
+		revisit_deferred = 1;
+	
 	return YES;
 }	
 
+// The static universe only changes when bellman_choose_cells sets or clears a cell, but every
+// generation of bellman_evolve looks at the neighbourhood of the same static tile. So the shifted
+// static words, and the mask of cells next to a static ON cell, are kept per static tile and only
+// rebuilt when static_serial has moved on since they were last built.
+
+typedef struct {
+	TILE_WORD l0, c0, r0;
+	TILE_WORD l1, c1, r1;
+} stable_row;
+
+typedef struct {
+	unsigned long serial;
+	stable_row rows[TILE_HEIGHT + 2]; // rows -1 .. TILE_HEIGHT, so row y is at rows[y + 1]
+	TILE_WORD set_mask[TILE_HEIGHT];
+	TILE_WORD maybe_set_mask[TILE_HEIGHT]; // same, but also next to unknown static cells
+} stable_words;
+
+static unsigned long static_serial = 1;
+
+static stable_words *get_stable_words(tile *stable) {
+	stable_words *sw = (stable_words *)stable->stable_words;
+	
+	if(!sw) {
+		sw = calloc(1, sizeof(stable_words));
+		if(!sw) {
+			fprintf(stderr, "Out of memory\n");
+			exit(-1);
+		}
+		stable->stable_words = sw;
+	}
+	
+	if(sw->serial == static_serial)
+		return sw;
+	
+	int y;
+	stable_row *r;
+	
+	r = &sw->rows[0];
+	if(stable->up) {
+		GET3WORDS(r->l0, r->c0, r->r0, stable->up, 0, TILE_HEIGHT-1);
+		GET3WORDS(r->l1, r->c1, r->r1, stable->up, 1, TILE_HEIGHT-1);
+	} else {
+		r->l0 = r->c0 = r->r0 = 0;
+		r->l1 = r->c1 = r->r1 = 0;
+	}
+	
+	for(y=0; y<TILE_HEIGHT; y++) {
+		r = &sw->rows[y + 1];
+		GET3WORDS(r->l0, r->c0, r->r0, stable, 0, y);
+		GET3WORDS(r->l1, r->c1, r->r1, stable, 1, y);
+	}
+	
+	r = &sw->rows[TILE_HEIGHT + 1];
+	if(stable->down) {
+		GET3WORDS(r->l0, r->c0, r->r0, stable->down, 0, 0);
+		GET3WORDS(r->l1, r->c1, r->r1, stable->down, 1, 0);
+	} else {
+		r->l0 = r->c0 = r->r0 = 0;
+		r->l1 = r->c1 = r->r1 = 0;
+	}
+	
+	// Generate a mask representing anything that's set in
+	// the stable region.
+	for(y=0; y<TILE_HEIGHT; y++) {
+		TILE_WORD set_mask = 0, maybe_set_mask = 0;
+		for(r = &sw->rows[y]; r <= &sw->rows[y + 2]; r++) {
+			set_mask |= (r->l0 & ~r->l1) | (r->c0 & ~r->c1) | (r->r0 & ~r->r1);
+			maybe_set_mask |= r->l0 | r->c0 | r->r0;
+		}
+		sw->set_mask[y] = set_mask;
+		sw->maybe_set_mask[y] = maybe_set_mask;
+	}
+	
+	sw->serial = static_serial;
+	return sw;
+}
+
 static evolve_result bellman_evolve(tile *t, tile *out) {
 	
+	tiles_evolved++;
+	
 	// Our evolution function is based on the 3 state Life variant.
 	out->flags = tile_evolve_bitwise_3state(t, out) | CHANGED;
 	
@@ -620,17 +1195,16 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 	// violations.
 	
 	tile *stable = (tile *)t->auxdata;
+	out->unknown_rows = 0;
 	if(!stable) return out->flags;
 	tile *forbidden = (tile *)stable->auxdata;
 	tile *filter = t->filter;
-	tile *prev = t->prev;
+	tile *prev = (t - u_evolving->tiles >= u_evolving->ntiles) ? t - u_evolving->ntiles : NULL;
 	
 	int y;
 	
 	TILE_WORD ul_bit0, u_bit0, ur_bit0;
 	TILE_WORD ul_bit1, u_bit1, ur_bit1;
-	TILE_WORD ul_bit0s, u_bit0s, ur_bit0s;
-	TILE_WORD ul_bit1s, u_bit1s, ur_bit1s;
 	
 	tile *t_up = t->up;
 	
@@ -643,33 +1217,21 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 		ul_bit1 = u_bit1 = ur_bit1 = 0;
 	}
 	
-	t_up = stable->up;
-	if(t_up) {
-		GET3WORDS(ul_bit0s, u_bit0s, ur_bit0s, t_up, 0, TILE_HEIGHT-1);
-		GET3WORDS(ul_bit1s, u_bit1s, ur_bit1s, t_up, 1, TILE_HEIGHT-1);
-	} else {
-		ul_bit0s = u_bit0s = ur_bit0s = 0;
-		ul_bit1s = u_bit1s = ur_bit1s = 0;
-	}
-	
+	stable_words *sw = get_stable_words(stable);
 	
 	TILE_WORD l_bit0, bit0, r_bit0;
 	TILE_WORD l_bit1, bit1, r_bit1;
-	TILE_WORD l_bit0s, bit0s, r_bit0s;
-	TILE_WORD l_bit1s, bit1s, r_bit1s;
 	
 	GET3WORDS(l_bit0, bit0, r_bit0, t, 0, 0);
 	GET3WORDS(l_bit1, bit1, r_bit1, t, 1, 0);
-	GET3WORDS(l_bit0s, bit0s, r_bit0s, stable, 0, 0);
-	GET3WORDS(l_bit1s, bit1s, r_bit1s, stable, 1, 0);
 	
 	TILE_WORD dl_bit0, d_bit0, dr_bit0;
 	TILE_WORD dl_bit1, d_bit1, dr_bit1;
-	TILE_WORD dl_bit0s, d_bit0s, dr_bit0s;
-	TILE_WORD dl_bit1s, d_bit1s, dr_bit1s;
 	TILE_WORD all_non_active = 0;
 	
 	TILE_WORD interaction = 0, activity = 0, unk_succ = 0, delta_from_stable_count = 0;
+	TILE_WORD maybe_active = 0;
+	uint64_t unknown_rows = 0;
 	TILE_WORD delta_from_previous_count = 0;
 	TILE_WORD has_ON_cells = 0;
 	
@@ -686,18 +1248,9 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 				dl_bit0 = d_bit0 = dr_bit0 = 0;
 				dl_bit1 = d_bit1 = dr_bit1 = 0;
 			}
-			if(stable->down) {
-				GET3WORDS(dl_bit0s, d_bit0s, dr_bit0s, stable->down, 0, 0);
-				GET3WORDS(dl_bit1s, d_bit1s, dr_bit1s, stable->down, 1, 0);
-			} else {
-				dl_bit0s = d_bit0s = dr_bit0s = 0;
-				dl_bit1s = d_bit1s = dr_bit1s = 0;
-			}
 		} else {
 			GET3WORDS(dl_bit0, d_bit0, dr_bit0, t, 0, y+1);
 			GET3WORDS(dl_bit1, d_bit1, dr_bit1, t, 1, y+1);
-			GET3WORDS(dl_bit0s, d_bit0s, dr_bit0s, stable, 0, y+1);
-			GET3WORDS(dl_bit1s, d_bit1s, dr_bit1s, stable, 1, y+1);
 		}
 		
 		// Note that this optimization is not implemented - all_non_active is always 0
@@ -707,53 +1260,39 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 			// Any neighbourhood which is identical to the stable
 			// universe should remain stable.
 			
+			stable_row *sa = &sw->rows[y], *sm = &sw->rows[y + 1], *sb = &sw->rows[y + 2];
+			TILE_WORD bit0s = sm->c0, bit1s = sm->c1;
+			
 			TILE_WORD stable_diff_above = 0;
-			stable_diff_above |= (ul_bit0s ^ ul_bit0);
-			stable_diff_above |= (ul_bit1s ^ ul_bit1);
-			stable_diff_above |= (u_bit0s ^ u_bit0);
-			stable_diff_above |= (u_bit1s ^ u_bit1);
-			stable_diff_above |= (ur_bit0s ^ ur_bit0);
-			stable_diff_above |= (ur_bit1s ^ ur_bit1);
+			stable_diff_above |= (sa->l0 ^ ul_bit0);
+			stable_diff_above |= (sa->l1 ^ ul_bit1);
+			stable_diff_above |= (sa->c0 ^ u_bit0);
+			stable_diff_above |= (sa->c1 ^ u_bit1);
+			stable_diff_above |= (sa->r0 ^ ur_bit0);
+			stable_diff_above |= (sa->r1 ^ ur_bit1);
 			
 			TILE_WORD stable_diff_mid = 0;
-			stable_diff_mid |= (l_bit0s ^ l_bit0);
-			stable_diff_mid |= (l_bit1s ^ l_bit1);
+			stable_diff_mid |= (sm->l0 ^ l_bit0);
+			stable_diff_mid |= (sm->l1 ^ l_bit1);
 			stable_diff_mid |= (bit0s ^ bit0);
 			stable_diff_mid |= (bit1s ^ bit1);
-			stable_diff_mid |= (r_bit0s ^ r_bit0);
-			stable_diff_mid |= (r_bit1s ^ r_bit1);
+			stable_diff_mid |= (sm->r0 ^ r_bit0);
+			stable_diff_mid |= (sm->r1 ^ r_bit1);
 			
 			TILE_WORD stable_diff_below = 0;
-			stable_diff_below |= (dl_bit0s ^ dl_bit0);
-			stable_diff_below |= (dl_bit1s ^ dl_bit1);
-			stable_diff_below |= (d_bit0s ^ d_bit0);
-			stable_diff_below |= (d_bit1s ^ d_bit1);
-			stable_diff_below |= (dr_bit0s ^ dr_bit0);
-			stable_diff_below |= (dr_bit1s ^ dr_bit1);
+			stable_diff_below |= (sb->l0 ^ dl_bit0);
+			stable_diff_below |= (sb->l1 ^ dl_bit1);
+			stable_diff_below |= (sb->c0 ^ d_bit0);
+			stable_diff_below |= (sb->c1 ^ d_bit1);
+			stable_diff_below |= (sb->r0 ^ dr_bit0);
+			stable_diff_below |= (sb->r1 ^ dr_bit1);
 			
 			TILE_WORD diff_mask = stable_diff_above | stable_diff_mid | stable_diff_below;
 			
 			out->bit0[y] = (out->bit0[y] & diff_mask) | (stable->bit0[y] & ~diff_mask);
 			out->bit1[y] = (out->bit1[y] & diff_mask) | (stable->bit1[y] & ~diff_mask);
 			
-			// Generate a mask representing anything that's set in
-			// the stable region.
-			TILE_WORD stable_set_above = 0;
-			stable_set_above |= (ul_bit0s & ~ul_bit1s);
-			stable_set_above |= (u_bit0s & ~u_bit1s);
-			stable_set_above |= (ur_bit0s & ~ur_bit1s);
-			
-			TILE_WORD stable_set_mid = 0;
-			stable_set_mid |= (l_bit0s & ~l_bit1s);
-			stable_set_mid |= (bit0s & ~bit1s);
-			stable_set_mid |= (r_bit0s & ~r_bit1s);
-			
-			TILE_WORD stable_set_below = 0;
-			stable_set_below |= (dl_bit0s & ~dl_bit1s);
-			stable_set_below |= (d_bit0s & ~d_bit1s);
-			stable_set_below |= (dr_bit0s & ~dr_bit1s);
-			
-			TILE_WORD set_mask = stable_set_above | stable_set_mid | stable_set_below;
+			TILE_WORD set_mask = sw->set_mask[y];
 			
 			// Look for places where the output differs from the
 			// stable input
@@ -766,6 +1305,10 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 			delta_from_stable &= set_mask;
 			interaction |= delta_from_stable;
 			
+			// The active cells counted here are only a lower bound while there are unknown
+			// cells around. Also look for cells that may or may not turn out to be active.
+			maybe_active |= sw->maybe_set_mask[y] & ((out->bit0[y] ^ bit0s) | (out->bit1[y] ^ bit1s)) & ~delta_from_stable;
+			
 			// Have any forbidden cells changed?
 			if(forbidden)
 				forbid |= forbidden->bit0[y] & (was0now1 | was1now0);
@@ -812,8 +1355,11 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 				
 			}
 			
-			// Look for unknown successors
-			unk_succ |= (out->bit1[y] & ~out->bit0[y]);
+			// Look for unknown successors, and remember which rows have them
+			TILE_WORD row_unk = (out->bit1[y] & ~out->bit0[y]);
+			unk_succ |= row_unk;
+			if(row_unk)
+				unknown_rows |= ((uint64_t)1) << y;
 			
 			//Update has on cells flag.
 			has_ON_cells |= (~out->bit1[y] & out->bit0[y]);
@@ -843,12 +1389,6 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 		l_bit0 = dl_bit0; bit0 = d_bit0; r_bit0 = dr_bit0;
 		l_bit1 = dl_bit1; bit1 = d_bit1; r_bit1 = dr_bit1;
 		
-		ul_bit0s = l_bit0s; u_bit0s = bit0s; ur_bit0s = r_bit0s;
-		ul_bit1s = l_bit1s; u_bit1s = bit1s; ur_bit1s = r_bit1s;
-		
-		l_bit0s = dl_bit0s; bit0s = d_bit0s; r_bit0s = dr_bit0s;
-		l_bit1s = dl_bit1s; bit1s = d_bit1s; r_bit1s = dr_bit1s;
-		
 	}
 	
 	// The delta_from_stable and delta_from_previous counters are
@@ -862,6 +1402,7 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 	
 	out->n_active = delta_from_stable_count;
 	out->delta_prev = delta_from_previous_count;
+	out->unknown_rows = unknown_rows;
 	
 	if(interaction != 0) out->flags |= DIFFERS_FROM_STABLE;
 	if(unk_succ != 0) out->flags |= HAS_UNKNOWN_CELLS;
@@ -870,23 +1411,53 @@ static evolve_result bellman_evolve(tile *t, tile *out) {
 	if(activity != 0) out->flags |= DIFFERS_FROM_PREVIOUS;
 	if((activity2 != 0) || !prev) out->flags |= DIFFERS_FROM_2PREV;
 	if(live != 0) out->flags |= IS_LIVE;
+	if(maybe_active != 0) out->flags |= MAY_BE_ACTIVE;
 	if(filter_diff_all != 0) out->flags |= FILTER_MISMATCH;
 	
 	return out->flags;
 }
 
+static void bellman_evolve_generation(generation *g) {
+	gens_evolved++;
+	generation_evolve(g, bellman_evolve);
+	g->next->escaped_gliders = g->escaped_gliders;
+}
+
 static generation *bellman_evolve_generations(generation *g, int end) {
 	tile *t;
 	g->flags |= CHANGED;
 	
-	for(t = g->all_first; t; t = t->all_next)
+	for(t = g->tiles + u_evolving->used_lo; t < g->tiles + u_evolving->used_hi; t++)
 		t->flags |= CHANGED;
 	
-	while((int) g->gen < end) {
-		generation_evolve(g, bellman_evolve);
-		g = g->next;
-	}
-	return g->prev;
+	for(; (int) g->gen < end; g++)
+		bellman_evolve_generation(g);
+	
+	return g - 1;
+}
+
+// Move the evolving universe into one [max_gens + 1][ntiles] block of tiles, so that
+// the search can walk generations and tiles by index. Nothing travels faster than one
+// cell per generation, so a margin of max_gens cells around the initial pattern is
+// enough to hold everything that can evolve during the search.
+static void make_evolving_contiguous ()
+{
+	int left = INT_MAX, right = INT_MIN, top = INT_MAX, bottom = INT_MIN;
+	generation *g;
+	tile *t;
+	
+	for (g = u_evolving->first; g; g = g->next)
+		for (t = g->all_first; t; t = t->all_next)
+		{
+			int margin = (g == u_evolving->first) ? max_gens + 1 : 0;
+			
+			left = lowest_of (left, t->xpos - margin);
+			right = highest_of (right, t->xpos + TILE_WIDTH - 1 + margin);
+			top = lowest_of (top, t->ypos - margin);
+			bottom = highest_of (bottom, t->ypos + TILE_HEIGHT - 1 + margin);
+		}
+	
+	universe_make_contiguous (u_evolving, left, top, right, bottom);
 }
 
 static void dump(int full) {
@@ -916,7 +1487,12 @@ static int is_on_cell (const generation *g, int x, int y)
 
 static int glider_bits [] = {0x008f, 0x015a, 0x006b, 0x011e, 0x012e, 0x0073, 0x00a7, 0x0172, 0x01e2, 0x00b5, 0x01ac, 0x00f1, 0x00e9, 0x019c, 0x01ca, 0x009d};
 
-static int is_center_cell_of_glider (const generation *g, int x, int y)
+// Direction of travel of each glider in glider_bits
+static int glider_dx [] = {1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1, -1};
+static int glider_dy [] = {1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 1, 1, 1};
+
+// Returns the index into glider_bits of the glider centered at (x, y), or -1
+static int glider_at (const generation *g, int x, int y)
 {
 	int bits = 0;
 	int xi;
@@ -933,12 +1509,17 @@ static int is_center_cell_of_glider (const generation *g, int x, int y)
 			int bix;
 			for (bix = -2; bix < 2; bix++)
 				if (is_on_cell (g, x + bix, y - 2) || is_on_cell (g, x + bix + 1, y + 2) || is_on_cell (g, x - 2, y + bix + 1) || is_on_cell (g, x + 2, y + bix))
-					return NO;
+					return -1;
 			
-			return YES;
+			return gl_ix;
 		}
 	
-	return NO;
+	return -1;
+}
+
+static int is_center_cell_of_glider (const generation *g, int x, int y)
+{
+	return glider_at (g, x, y) >= 0;
 }
 
 static int count_gliders (const generation *g)
@@ -982,843 +1563,3735 @@ static int count_gliders (const generation *g)
 	return gl_cnt;
 }
 
-static void print_activation_gens (FILE *f, int act_count, int act_gen [])
+#define MAX_LOOSE_CELLS 256
+#define MAX_LOOSE_GLIDERS 32
+
+// Empty space kept between an escaping glider and anything else, so that it
+// cannot have been interacting in the previous generation either
+#define ESCAPE_GAP 3
+
+typedef struct {
+	int left, right, top, bottom;
+} bounds;
+
+static void bounds_add (bounds *b, int left, int right, int top, int bottom)
 {
-	int a_ix;
-	for (a_ix = 0; a_ix < act_count; a_ix++)
-	{
-		fprintf (f, "%d", act_gen [a_ix]);
-		if (a_ix < act_count - 1)
-			fprintf (f, ", ");
-		else
-			fprintf (f, "\n");
-	}
+	b->left = lowest_of (b->left, left);
+	b->right = highest_of (b->right, right);
+	b->top = lowest_of (b->top, top);
+	b->bottom = highest_of (b->bottom, bottom);
 }
 
-static void bellman_found_solution (int accept_gen, int max_active, int glider_count, int act_count, int act_gen [])
+// Is the box [left, right] x [top, bottom], moving by (dx, dy), more than gap cells clear of b and never getting closer?
+// b may be moving too, by (bdx, bdy); that is (0, 0) for everything but other gliders.
+static int moves_away (int left, int right, int top, int bottom, int dx, int dy, const bounds *b, int bdx, int bdy, int gap)
 {
-	solcount++;
-	last_sol_time = time (NULL);
+	if (b->left > b->right)
+		return YES;
 	
-	printf ("--- Found solution %d, accepted at gen %d, max active cells: %d\n", solcount, accept_gen, max_active);
-	printf ("      Gliders: %d, activations at gen ", glider_count);
-	print_activation_gens (stdout, act_count, act_gen);
+	return (left > b->right + gap && dx >= bdx) ||
+	       (right < b->left - gap && dx <= bdx) ||
+	       (top > b->bottom + gap && dy >= bdy) ||
+	       (bottom < b->top - gap && dy <= bdy);
+}
+
+// Row of bits shifted left by shift, which may be negative
+static TILE_WORD shifted_row (TILE_WORD bits, int shift)
+{
+	if (shift <= -TILE_WIDTH || shift >= TILE_WIDTH)
+		return 0;
+	
+	return shift < 0 ? bits >> -shift : bits << shift;
+}
+
+// Bounds of the static pattern, including its unknown cells, and of the forbidden region
+static bounds static_bounds;
+static unsigned long static_bounds_serial = 0;
+
+static const bounds *get_static_bounds ()
+{
+	if (static_bounds_serial == static_serial)
+		return &static_bounds;
 	
-	char name[30];
+	bounds b = {INT_MAX, INT_MIN, INT_MAX, INT_MIN};
+	int l, r, top, bottom;
 	tile *t;
 	
-	if (new_result_naming)
-		snprintf(name, sizeof name, "result%06d.out", solcount);
-	else
-		snprintf(name, sizeof name, "result%06d-4.out", solcount);
-	
-	FILE *f = fopen(name, "w");
-	if(f) {
-		
-		fprintf (f, "#S %s %d\n", PARM_MIN_FIRST_ACT_GEN, min_first_act_gen);
-		fprintf (f, "#S %s %d\n", PARM_MAX_FIRST_ACT_GEN, max_first_act_gen);
-		fprintf (f, "#S %s %d\n", PARM_STRICTLY_GEN_BY_GEN, strictly_gen_by_gen);
-		fprintf (f, "#S %s %d\n", PARM_MAX_LAST_ACT_GEN, max_last_act_gen);
-		fprintf (f, "#S %s %d\n", PARM_MAX_ACT_WINDOW_GENS, max_act_window_gens);
-		fprintf (f, "#S %s %d\n", PARM_MAX_CONS_ACT_GENS, max_cons_act_gens);
-		fprintf (f, "#S %s %d\n", PARM_ACCEPT1_INACT_GENS, accept1_inact_gens);
-		fprintf (f, "#S %s %d\n", PARM_ACCEPT2_ACT_INACT_GENS, accept2_act_inact_gens);
-		fprintf (f, "#S %s %d\n", PARM_ACCEPT2_MIN_INACT_GENS, accept2_min_inact_gens);
-		fprintf (f, "#S %s %d\n", PARM_CONT_AFTER_ACCEPT, cont_after_accept);
-		fprintf (f, "#S %s %d\n", PARM_MAX_ADDED_STATIC_ON, max_added_static_on);
-		fprintf (f, "#S %s %d\n", PARM_MAX_ACT_CELLS, max_act_cells);
-		fprintf (f, "#S %s %d\n", PARM_FILTER_MIN_ACT_CELLS, filter_min_act_cells);
-		fprintf (f, "#S %s %d\n", PARM_MAX_LOCAL_RECT_COMPL, max_local_rect_compl);
-		fprintf (f, "#S %s %d\n", PARM_MAX_OVERALL_LOCAL_COMPL, max_overall_local_compl);
-		fprintf (f, "#S %s %d\n", PARM_MAX_LOCAL_RECTS, max_local_rects);
-		fprintf (f, "#S %s %d\n", PARM_MIN_RECT_SEPARATION_SQ, min_rect_separation_sq);
-		fprintf (f, "#S %s %d\n", PARM_MAX_GLOBAL_COMPL, max_global_compl);
-		fprintf (f, "#S %s %d\n", PARM_NEW_RESULT_NAMING, new_result_naming);
-		fprintf (f, "#S %s %d\n", PARM_MAX_RESULTS, max_results);
-
-		if (symmetry_type == HORIZ)
-			if (symmetry_ofs & 0x00000001)
-				fprintf (f, "#S %s %d\n", PARM_SYM_HORZ_ODD, symmetry_ofs / 2);
-			else
-				fprintf (f, "#S %s %d\n", PARM_SYM_HORZ_EVEN, (symmetry_ofs - 1) / 2);
-		else if (symmetry_type == VERT)
-		{
-			if (symmetry_ofs & 0x00000001)
-				fprintf (f, "#S %s %d\n", PARM_SYM_VERT_ODD, symmetry_ofs / 2);
-			else
-				fprintf (f, "#S %s %d\n", PARM_SYM_VERT_EVEN, (symmetry_ofs - 1) / 2);
-		}
-		
-		fprintf (f, "#C Search made using %s, %s\n", program_name, version_string);
-		fprintf (f, "#C Solution accepted at generation %d\n", accept_gen);
-		fprintf (f, "#C Activations at generation ");
-		print_activation_gens (f, act_count, act_gen);
-		fprintf (f, "#C Max active cells %d\n", max_active);
-		fprintf (f, "#C Glider count at accept %d\n", glider_count);
+	for (t = u_static->first->all_first; t; t = t->all_next)
+	{
+		tile_find_bounds (t, &l, &r, &top, &bottom);
+		if (l <= r)
+			bounds_add (&b, t->xpos + l, t->xpos + r, t->ypos + top, t->ypos + bottom);
 		
-		for(t = u_static->first->all_first; t; t = t->all_next) {
-			tile *t2 = universe_find_tile(u_evolving, 0, t->xpos, t->ypos, 0);
-			fprintf(f, "#P %d %d\n", t->xpos, t->ypos);
-			
-			int x, y;
-			
-			for(y=0; y<TILE_HEIGHT; y++) {
-				for(x=0; x<TILE_WIDTH; x++) {
-					char c = '.';
-					
-					if(t2 && tile_get_cell(t2, x, y) == ON)
-						c = '@';
-					
-					if(tile_get_cell(t, x, y) == ON)
-						c = '*';
-					else if(tile_get_cell(t, x, y) != OFF)
-						c = '?';
-					
-					fputc(c, f);
-				}
-				fputc('\n', f);
-			}
+		tile *forbidden = (tile *) t->auxdata;
+		if (forbidden)
+		{
+			tile_find_bounds (forbidden, &l, &r, &top, &bottom);
+			if (l <= r)
+				bounds_add (&b, forbidden->xpos + l, forbidden->xpos + r, forbidden->ypos + top, forbidden->ypos + bottom);
 		}
-		
-		fclose(f);
-	} else perror(name);
+	}
+	
+	static_bounds = b;
+	static_bounds_serial = static_serial;
+	return &static_bounds;
 }
 
-/*
-typedef enum {FILTER_MATCH_NO, FILTER_MATCH_YES, FILTER_MATCH_UNKNOWN} filter_match;
-
-static filter_match compare_filter_tile (const tile *filter, const tile *pattern)
+// Check if generation g, which has no unknown cells and no active cells, has reached a fixed point,
+// so that every later generation will look the same to bellman_recurse. Escaping gliders don't
+// stop this from happening, as remove_escaping_gliders takes them out of the pattern.
+static int generation_is_settled (generation *g)
 {
-	TILE_WORD mismatch = 0;
-	TILE_WORD unknown = 0;
-
+	universe *u = g->u;
+	
+	if (g == u->gens || (int) g->gen + 1 < (int) u_filter->n_gens)
+		return NO;
+	
+	tile *t, *tp;
 	int y;
 	
-	if (pattern)
-		for (y = 0; y < TILE_HEIGHT; y++)
-		{
-			mismatch |= (filter->bit0 [y] ^ pattern->bit0 [y]) & ~(filter->bit1 [y] | pattern->bit1 [y]);
-			unknown |= ~filter->bit1 [y] & pattern->bit1 [y];
-		}
-	else
+	for (t = g->tiles + u->used_lo, tp = t - u->ntiles; t < g->tiles + u->used_hi; t++, tp++)
 		for (y = 0; y < TILE_HEIGHT; y++)
-			mismatch |= filter->bit0 [y];
+			if ((t->bit0 [y] ^ tp->bit0 [y]) | (t->bit1 [y] ^ tp->bit1 [y]))
+				return NO;
 	
-	if (mismatch)
-		return FILTER_MATCH_NO;
-	else if (unknown)
-		return FILTER_MATCH_UNKNOWN;
-	else
-		return FILTER_MATCH_YES;
-}
-
-static filter_match test_filter (
-{
+	return YES;
 }
-*/
 
-static int verify_static_is_stable ()
+// Find gliders that have left the static pattern, the forbidden region, any debris and all other
+// gliders behind, so that they can't interact with anything before the last generation. Their
+// cells are cleared from g, so that they aren't evolved any further, and they are counted in
+// g->escaped_gliders instead. g must not have any unknown cells. Returns the number of gliders removed.
+static int remove_escaping_gliders (generation *g)
 {
-	// TODO: check only the neighbourhood of the cell we just modified!
+	universe *u = g->u;
 	
-	tile *t;
-	for(t = u_static->first->all_first; t; t = t->all_next)
-	{
-		evolve_result res = tile_stabilise_3state (t, t->next);
-		if (res & ABORT)
-			return NO;
-	}
+	// A filter might still be looking for the glider
+	if ((int) g->gen + 1 < (int) u_filter->n_gens)
+		return 0;
 	
-	return YES;
-}
-
-// Forward declaration to allow mutual calls between bellman_choose_cells and bellman_recurse
-static void bellman_choose_cells (universe *u, generation *g, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen);
-
-typedef enum {PHASE_NOT_ACTIVATED_YET, PHASE_ACTIVE, PHASE_RESTORED_NOT_YIELDED, PHASE_RESTORED_YIELDED} evolution_phase;
-
-static int activation_gen [MAX_LISTED_ACTIVATIONS];
-
-static int bellman_recurse (universe *u, generation *g, int allow_new_oncells, int previous_first_gen_with_unknown_cells, int first_next_sol_gen)
-{
-	print_prune_counters (NO);
-		
-	// First make sure the static pattern is truly static
-	// Note that both a new static on-cell and a new static off-cell can cause the static pattern to become impossible to make stable
-	if (!verify_static_is_stable ())
-	{
-		prune_unstable++;
-		return YES;
-	}
+	const bounds *fixed = get_static_bounds ();
+	if (fixed->left > fixed->right)
+		return 0;
 	
-// REINTRODUCTION OF FIXED CATALYSTS
-//	if (!ver_cats (g))
-//		return YES;
+	// Nothing near the static pattern can be an escaping glider, so only look at cells further away
+	int cell_x [MAX_LOOSE_CELLS], cell_y [MAX_LOOSE_CELLS];
+	int n_cells = 0;
 	
-	// Evolve any changes up to previous first gen with unknown cells
-	generation *ge;
-	for(ge = u->first; ge && ge->next; ge = ge->next)
+	tile *t;
+	int y;
+	
+	for (t = g->tiles + u->used_lo; t < g->tiles + u->used_hi; t++)
 	{
-		if(ge->flags & CHANGED)
+		// Only tiles with cells that differ from the static pattern can hold a glider
+		if (!(t->flags & IS_LIVE))
+			continue;
+		
+		int lo = fixed->left - ESCAPE_GAP - t->xpos;
+		int hi = fixed->right + ESCAPE_GAP - t->xpos;
+		
+		TILE_WORD near = 0;
+		if (lo < TILE_WIDTH && hi >= 0)
 		{
-			ge->flags &= ~CHANGED;
-			generation_evolve(ge, bellman_evolve);
+			lo = highest_of (lo, 0);
+			hi = lowest_of (hi, TILE_WIDTH - 1);
+			near = (~(TILE_WORD) 0 >> (TILE_WIDTH - 1 - hi)) & (~(TILE_WORD) 0 << lo);
 		}
 		
-		if ((int) ge->gen == previous_first_gen_with_unknown_cells)
-			break;
+		for (y = 0; y < TILE_HEIGHT; y++)
+		{
+			TILE_WORD cells = t->bit0 [y] | t->bit1 [y];
+			if (t->ypos + y >= fixed->top - ESCAPE_GAP && t->ypos + y <= fixed->bottom + ESCAPE_GAP)
+				cells &= ~near;
+			
+			for (; cells; cells &= cells - 1)
+			{
+				if (n_cells == MAX_LOOSE_CELLS)
+					return 0;
+				
+				cell_x [n_cells] = t->xpos + __builtin_ffsll (cells) - 1;
+				cell_y [n_cells] = t->ypos + y;
+				n_cells++;
+			}
+		}
 	}
 	
-	// If there are still unknown cells in the same generation as before, just skip and pick another static cell to define
-	if (!(ge->flags & HAS_UNKNOWN_CELLS))
+	if (n_cells == 0)
+		return 0;
+	
+	int gl_x [MAX_LOOSE_GLIDERS], gl_y [MAX_LOOSE_GLIDERS], gl_ix [MAX_LOOSE_GLIDERS];
+	int n_gl = 0;
+	int i, j;
+	
+	for (i = 0; i < n_cells; i++)
 	{
-		// Now check that the evolving universe is behaving itself
+		for (j = 0; j < n_gl; j++)
+			if (abs (cell_x [i] - gl_x [j]) <= 1 && abs (cell_y [i] - gl_y [j]) <= 1)
+				break;
 		
-		evolution_phase phase = PHASE_NOT_ACTIVATED_YET;
-		int current_actn_first_gen = -1;
-		int last_allowed_act_gen = max_last_act_gen;
-		int last_allowed_act_limited_by_window = NO;
-		int current_restoration_gen = -1;
-		int unfiltered_accept_gen = -1;
-		int max_n_active = 0;
-		int n_activations = 0;
+		if (j < n_gl)
+			continue;
 		
-		for(ge = u->first; ge && ge->next; ge = ge->next)
+		int cx, cy, ix = -1;
+		for (cx = cell_x [i] - 1; cx <= cell_x [i] + 1; cx++)
 		{
-			if (ge->flags & CHANGED)
-			{
-				ge->flags &= ~CHANGED;
-				generation_evolve(ge, bellman_evolve);
-			}
+			for (cy = cell_y [i] - 1; cy <= cell_y [i] + 1; cy++)
+				if ((ix = glider_at (g, cx, cy)) >= 0)
+					break;
 			
-			// When we see the next generation with unknown cells, we skip and pick more static cells to define.
-			// Bellman used to go on with checking the generation here anyway. Which method is faster varies a lot with different search parameters.
-			// Ideally Bellman should pick the most efficient method itself, but in a first step this choice of behavious could be made a search
-			// parameter instead
-			if (ge->flags & HAS_UNKNOWN_CELLS)
+			if (ix >= 0)
 				break;
-			
-			int gen = (int) ge->gen;
-			
-			// Check if first activation should have happened by now
-			if (phase == PHASE_NOT_ACTIVATED_YET && (gen > max_first_act_gen || (strictly_gen_by_gen && gen > current_single_gen)))
-			{
-				prune_no_acty_in_time++;
-				return YES;
-			}
-			
-			// Check for first activation
-			// Verify that it doesn't happen too early
-			if (phase == PHASE_NOT_ACTIVATED_YET && ge->n_active > 0)
-			{
-				if (gen < min_first_act_gen || (strictly_gen_by_gen && gen < current_single_gen))
-				{
-					prune_first_acty_too_early++;
-					return YES;
-				}
-				else
-				{
-					phase = PHASE_ACTIVE;
-					current_actn_first_gen = gen;
-					if (max_act_window_gens != PARM_DISABLED && last_allowed_act_gen > gen + max_act_window_gens - 1)
-					{
-						last_allowed_act_gen = gen + max_act_window_gens - 1;
-						last_allowed_act_limited_by_window = YES;
-					}
-					if (n_activations < MAX_LISTED_ACTIVATIONS)
-						activation_gen [n_activations++] = gen;
-				}
-			}
-			
-			// We wanted to test for too early or too late activation first to spot any difference between normal mode and strictly-gen-by-gen mode
-			// After that, test for too much activity first, for performance
-			if (max_act_cells != PARM_DISABLED && (int) ge->n_active > max_act_cells)
+		}
+		
+		if (ix < 0)
+			continue;
+		
+		if (n_gl == MAX_LOOSE_GLIDERS)
+			return 0;
+		
+		gl_x [n_gl] = cx;
+		gl_y [n_gl] = cy;
+		gl_ix [n_gl] = ix;
+		n_gl++;
+	}
+	
+	if (n_gl == 0)
+		return 0;
+	
+	// Find the bounds of everything else, and check whether it was the same in the previous generation
+	bounds rest = *fixed;
+	int rest_is_still = (g != u->gens);
+	
+	for (t = g->tiles + u->used_lo; t < g->tiles + u->used_hi; t++)
+		for (y = 0; y < TILE_HEIGHT; y++)
+		{
+			TILE_WORD cells = t->bit0 [y] | t->bit1 [y];
+			TILE_WORD diff = 0;
+			if (rest_is_still)
 			{
-				prune_too_many_act_cells++;
-				return YES;
+				tile *tp = t - u->ntiles;
+				diff = (t->bit0 [y] ^ tp->bit0 [y]) | (t->bit1 [y] ^ tp->bit1 [y]);
 			}
 			
-			max_n_active = highest_of (max_n_active, ge->n_active);
-			
-			// Check if all catalysts are restored and inactive after an ongoing activation
-			if (phase == PHASE_ACTIVE && ge->n_active == 0)
+			for (j = 0; j < n_gl; j++)
 			{
-				phase = PHASE_RESTORED_NOT_YIELDED;
-				current_restoration_gen = gen;
+				int dy = t->ypos + y - gl_y [j];
+				int dx = gl_x [j] - t->xpos;
 				
-				if (accept1_inact_gens == PARM_DISABLED)
-					unfiltered_accept_gen = highest_of (current_restoration_gen + accept2_min_inact_gens - 1, current_actn_first_gen + accept2_act_inact_gens - 1);
-				else if (accept2_act_inact_gens == PARM_DISABLED)
-				 	unfiltered_accept_gen = current_restoration_gen + accept1_inact_gens - 1;
-				else
-					unfiltered_accept_gen = lowest_of (current_restoration_gen + accept1_inact_gens - 1, highest_of (current_restoration_gen + accept2_min_inact_gens - 1, current_actn_first_gen + accept2_act_inact_gens - 1));
+				// The glider may have been one cell further back in the previous generation
+				if (dy >= -2 && dy <= 2)
+					diff &= ~shifted_row (0x1f, dx - 2);
 				
-				if (accept2_act_inact_gens != PARM_DISABLED)
-					unfiltered_accept_gen = lowest_of (unfiltered_accept_gen, highest_of (current_restoration_gen + accept2_min_inact_gens - 1, current_actn_first_gen + accept2_act_inact_gens - 1));
-			}
-			
-			// Check for reactivation. This could be before the previous activation was accepted as a solution,
-			// or it could be a search for further solutions if cont_after_accept is set. 
-			if ((phase == PHASE_RESTORED_NOT_YIELDED || phase == PHASE_RESTORED_YIELDED) && ge->n_active > 0)
-			{
-				phase = PHASE_ACTIVE;
-				current_actn_first_gen = gen;
-				if (n_activations < MAX_LISTED_ACTIVATIONS)
-					activation_gen [n_activations++] = gen;
+				if (dy >= -1 && dy <= 1)
+					cells &= ~shifted_row (0x07, dx - 1);
 			}
 			
-			// Check for activity after all activity should have stopped
-			if (ge->n_active > 0 && gen > last_allowed_act_gen)
-			{
-				if (last_allowed_act_limited_by_window)
-					prune_acty_window_too_long++;
-				else
-					prune_acty_too_late++;
-				
-				return YES;
-			}
+			if (diff)
+				rest_is_still = NO;
 			
-			// Note that if support is re-added for evaluating patterns with unknown evolving cells, this needs to be qualified with having no such cells
-			if (ge->flags & FILTER_MISMATCH)
-			{
-				// Consider it a prune or a filtering depending on if the filter is applied before or after the solution should have been accepted without the filter
-				if (phase == PHASE_RESTORED_NOT_YIELDED && gen >= unfiltered_accept_gen)
-					prune_explicit_filter_filtered++;
-				else
-					prune_explicit_filter_prune++;
-				return YES;
-			}
+			if (cells)
+				bounds_add (&rest, t->xpos + __builtin_ctzll (cells), t->xpos + TILE_WIDTH - 1 - __builtin_clzll (cells), t->ypos + y, t->ypos + y);
+		}
+	
+	int escaping [MAX_LOOSE_GLIDERS];
+	
+	// If everything else is still and all gliders are leaving it and each other behind, nothing
+	// will ever change shape again, so a small gap is enough to let them all go
+	if (rest_is_still)
+	{
+		for (i = 0; i < n_gl && rest_is_still; i++)
+		{
+			rest_is_still = moves_away (gl_x [i] - 1, gl_x [i] + 1, gl_y [i] - 1, gl_y [i] + 1, glider_dx [gl_ix [i]], glider_dy [gl_ix [i]], &rest, 0, 0, ESCAPE_GAP);
 			
-			if (ge->flags & IN_FORBIDDEN_REGION)
+			for (j = i + 1; j < n_gl && rest_is_still; j++)
 			{
-				prune_forbidden++;
-				return YES;
+				bounds other = {gl_x [j] - 1, gl_x [j] + 1, gl_y [j] - 1, gl_y [j] + 1};
+				rest_is_still = moves_away (gl_x [i] - 1, gl_x [i] + 1, gl_y [i] - 1, gl_y [i] + 1, glider_dx [gl_ix [i]], glider_dy [gl_ix [i]], &other, glider_dx [gl_ix [j]], glider_dy [gl_ix [j]], ESCAPE_GAP);
 			}
+		}
+		
+		for (i = 0; i < n_gl; i++)
+			escaping [i] = rest_is_still;
+	}
+	
+	// Otherwise anything else, including the other gliders, could grow by up to one cell per generation
+	// until the last one, while a glider only gets one cell further away every fourth generation
+	if (!rest_is_still)
+	{
+		int remaining = (int) u->n_gens - 1 - (int) g->gen;
+		int gap = ESCAPE_GAP + (3 * remaining + 3) / 4;
+		
+		for (i = 0; i < n_gl; i++)
+		{
+			escaping [i] = moves_away (gl_x [i] - 1, gl_x [i] + 1, gl_y [i] - 1, gl_y [i] + 1, glider_dx [gl_ix [i]], glider_dy [gl_ix [i]], &rest, 0, 0, gap);
 			
-			// Check if an ongoing activation has lasted too long without break
-			if (max_cons_act_gens != PARM_DISABLED && phase == PHASE_ACTIVE && gen > current_actn_first_gen + max_cons_act_gens + 1)
+			for (j = 0; j < n_gl && escaping [i]; j++)
 			{
-				prune_cons_acty_too_long++;
-				return YES;
+				bounds other = {gl_x [j] - 1, gl_x [j] + 1, gl_y [j] - 1, gl_y [j] + 1};
+				if (j != i)
+					escaping [i] = moves_away (gl_x [i] - 1, gl_x [i] + 1, gl_y [i] - 1, gl_y [i] + 1, glider_dx [gl_ix [i]], glider_dy [gl_ix [i]], &other, 0, 0, gap);
 			}
-			
-			// Check if all conditions for a solution are met
-			if (phase == PHASE_RESTORED_NOT_YIELDED)
-			{
-				int accept_gen = highest_of (unfiltered_accept_gen, u_filter->n_gens - 1);
-				
-				if (gen >= accept_gen)
-					phase = PHASE_RESTORED_YIELDED;
-				
-				if (gen == accept_gen && gen >= first_next_sol_gen)
+		}
+	}
+	
+	int n_removed = 0;
+	for (i = 0; i < n_gl; i++)
+	{
+		if (!escaping [i])
+			continue;
+		
+		int x;
+		for (x = gl_x [i] - 1; x <= gl_x [i] + 1; x++)
+			for (y = gl_y [i] - 1; y <= gl_y [i] + 1; y++)
+				tile_set_cell (generation_find_tile (g, x, y, NO), x, y, OFF);
+		
+		// Evolving the previous generation again sets g->escaped_gliders back to its count, so the
+		// tiles that the glider came from must be evolved with it, to bring the glider back into g
+		// where it is removed and counted again
+		if (g->prev)
+			for (x = gl_x [i] - 2; x <= gl_x [i] + 2; x++)
+				for (y = gl_y [i] - 2; y <= gl_y [i] + 2; y++)
 				{
-					// Filter out solutions that are too simple
-					if (filter_min_act_cells == PARM_DISABLED || max_n_active >= filter_min_act_cells)
-					{
-						bellman_found_solution (gen, max_n_active, count_gliders (ge), n_activations, activation_gen);
-						prune_solution++;
-					}
-					else
-						prune_filter_too_few_act_cells++;
-					
-					if (cont_after_accept)
-						first_next_sol_gen = gen + 1;
-					else
-						return YES;
+					tile *tp = generation_find_tile (g->prev, x, y, NO);
+					if (tp)
+						tp->flags |= CHANGED;
 				}
-			}
-			
-			// Check if we can stop looking for a solution in continue_after_accept mode
-			if (gen > last_allowed_act_gen && phase == PHASE_RESTORED_YIELDED)
-			{
-				prune_no_cont_found++;
-				return YES;
-			}
-			
-			// Stop adding new on-cells when it's too late to start a new activation and there is currently no ongoing activation
-			// This prevents a lot of irrelevant solutions with extra pixels that don't activate
-			if (gen > last_allowed_act_gen && (phase == PHASE_RESTORED_NOT_YIELDED || phase == PHASE_RESTORED_YIELDED))
-				allow_new_oncells = NO;
-		}
+		
+		n_removed++;
 	}
 	
-	if (max_results != PARM_DISABLED && solcount >= max_results)
-		return NO;
+	if (n_removed)
+	{
+		g->escaped_gliders += n_removed;
+		g->flags |= CHANGED;
+	}
 	
-	bellman_choose_cells(u, g, allow_new_oncells, ge->gen, first_next_sol_gen);
-	return YES;
+	return n_removed;
 }
 
-#define TRY(cdx, cdy)																										\
-	if(tile_get_cell(t->prev, x + cdx, y + cdy) == UNKNOWN_STABLE && validate_xy_for_symmetry(x + cdx, y + cdy) == YES) {	\
-		dx = cdx;																											\
-		dy = cdy;																											\
-		goto found;																											\
+static void print_activation_gens (FILE *f, int act_count, const int act_gen [])
+{
+	int a_ix;
+	for (a_ix = 0; a_ix < act_count; a_ix++)
+	{
+		fprintf (f, "%d", act_gen [a_ix]);
+		if (a_ix < act_count - 1)
+			fprintf (f, ", ");
+		else
+			fprintf (f, "\n");
 	}
+}
 
-static int validate_xy_for_symmetry(int x, int y)
+// The search parameters, as #S lines that can be read back in
+static void write_result_params (FILE *f)
 {
-	switch(symmetry_type) {
-	case NONE:
-		return YES;
-	case HORIZ:
-		if(y >= symmetry_ofs - y)
-			return YES;
+	fprintf (f, "#S %s %d\n", PARM_MIN_FIRST_ACT_GEN, min_first_act_gen);
+	fprintf (f, "#S %s %d\n", PARM_MAX_FIRST_ACT_GEN, max_first_act_gen);
+	fprintf (f, "#S %s %d\n", PARM_STRICTLY_GEN_BY_GEN, strictly_gen_by_gen);
+	fprintf (f, "#S %s %d\n", PARM_MAX_LAST_ACT_GEN, max_last_act_gen);
+	fprintf (f, "#S %s %d\n", PARM_MAX_ACT_WINDOW_GENS, max_act_window_gens);
+	fprintf (f, "#S %s %d\n", PARM_MAX_CONS_ACT_GENS, max_cons_act_gens);
+	fprintf (f, "#S %s %d\n", PARM_ACCEPT1_INACT_GENS, accept1_inact_gens);
+	fprintf (f, "#S %s %d\n", PARM_ACCEPT2_ACT_INACT_GENS, accept2_act_inact_gens);
+	fprintf (f, "#S %s %d\n", PARM_ACCEPT2_MIN_INACT_GENS, accept2_min_inact_gens);
+	fprintf (f, "#S %s %d\n", PARM_CONT_AFTER_ACCEPT, cont_after_accept);
+	fprintf (f, "#S %s %d\n", PARM_MAX_ADDED_STATIC_ON, max_added_static_on);
+	fprintf (f, "#S %s %d\n", PARM_ONCELL_DEEPENING, oncell_deepening);
+	fprintf (f, "#S %s %d\n", PARM_MAX_ACT_CELLS, max_act_cells);
+	fprintf (f, "#S %s %d\n", PARM_FILTER_MIN_ACT_CELLS, filter_min_act_cells);
+	fprintf (f, "#S %s %d\n", PARM_MAX_LOCAL_RECT_COMPL, max_local_rect_compl);
+	fprintf (f, "#S %s %d\n", PARM_MAX_OVERALL_LOCAL_COMPL, max_overall_local_compl);
+	fprintf (f, "#S %s %d\n", PARM_MAX_LOCAL_RECTS, max_local_rects);
+	fprintf (f, "#S %s %d\n", PARM_MIN_RECT_SEPARATION_SQ, min_rect_separation_sq);
+	fprintf (f, "#S %s %d\n", PARM_MAX_GLOBAL_COMPL, max_global_compl);
+	fprintf (f, "#S %s %d\n", PARM_NEW_RESULT_NAMING, new_result_naming);
+	fprintf (f, "#S %s %d\n", PARM_MAX_RESULTS, max_results);
+	fprintf (f, "#S %s %d\n", PARM_DEFER_SUBTREE_NODES, defer_subtree_nodes);
+	fprintf (f, "#S %s %d\n", PARM_DEFER_SUBTREE_LEVEL, defer_subtree_level);
+	fprintf (f, "#S %s %d\n", PARM_REVISIT_DEFERRED, revisit_deferred);
+
+	if (symmetry_type == HORIZ)
+		if (symmetry_ofs & 0x00000001)
+			fprintf (f, "#S %s %d\n", PARM_SYM_HORZ_ODD, symmetry_ofs / 2);
+		else
+			fprintf (f, "#S %s %d\n", PARM_SYM_HORZ_EVEN, (symmetry_ofs - 1) / 2);
+	else if (symmetry_type == VERT)
+	{
+		if (symmetry_ofs & 0x00000001)
+			fprintf (f, "#S %s %d\n", PARM_SYM_VERT_ODD, symmetry_ofs / 2);
+		else
+			fprintf (f, "#S %s %d\n", PARM_SYM_VERT_EVEN, (symmetry_ofs - 1) / 2);
+	}
+}
+
+// splitmix64 finaliser
+static uint64_t splitmix64 (uint64_t k)
+{
+	k += 0x9e3779b97f4a7c15;
+	k = (k ^ (k >> 30)) * 0xbf58476d1ce4e5b9;
+	k = (k ^ (k >> 27)) * 0x94d049bb133111eb;
+	return k ^ (k >> 31);
+}
+
+// What a result file needs of a solution: the static tiles and the active cells at generation 0.
+// The search goes on changing the universes, so the result writer works on a copy.
+typedef struct {
+	int xpos, ypos;
+	TILE_WORD bit0 [TILE_HEIGHT], bit1 [TILE_HEIGHT];
+	TILE_WORD active [TILE_HEIGHT];
+} snapshot_tile;
+
+typedef struct {
+	int id, worker_gen;
+	int accept_gen, max_active, glider_count;
+	int act_count, act_gen [MAX_LISTED_ACTIVATIONS];
+	int n_tiles;
+	snapshot_tile tiles [];
+} result_snapshot;
+
+static result_snapshot *take_result_snapshot (int accept_gen, int max_active, int glider_count, int act_count, int act_gen [])
+{
+	tile *t;
+	int n_tiles = 0;
+	
+	for (t = u_static->first->all_first; t; t = t->all_next)
+		n_tiles++;
+	
+	result_snapshot *s = malloc (sizeof (result_snapshot) + n_tiles * sizeof (snapshot_tile));
+	if (!s)
+	{
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
+	}
+	
+	s->id = solcount;
+	s->worker_gen = worker_gen;
+	s->accept_gen = accept_gen;
+	s->max_active = max_active;
+	s->glider_count = glider_count;
+	s->act_count = act_count;
+	memcpy (s->act_gen, act_gen, act_count * sizeof (int));
+	s->n_tiles = n_tiles;
+	
+	snapshot_tile *st = s->tiles;
+	for (t = u_static->first->all_first; t; t = t->all_next, st++)
+	{
+		tile *t2 = universe_find_tile (u_evolving, 0, t->xpos, t->ypos, 0);
+		int y;
+		
+		st->xpos = t->xpos;
+		st->ypos = t->ypos;
+		memcpy (st->bit0, t->bit0, sizeof st->bit0);
+		memcpy (st->bit1, t->bit1, sizeof st->bit1);
+		for (y = 0; y < TILE_HEIGHT; y++)
+			st->active [y] = t2 ? (t2->bit0 [y] & ~t2->bit1 [y]) : 0;
+	}
+	
+	return s;
+}
+
+static void write_result_body (FILE *f, const result_snapshot *s)
+{
+	const snapshot_tile *st;
+	
+	fprintf (f, "#C Search made using %s, %s\n", program_name, version_string);
+	fprintf (f, "#C Solution accepted at generation %d\n", s->accept_gen);
+	fprintf (f, "#C Activations at generation ");
+	print_activation_gens (f, s->act_count, s->act_gen);
+	fprintf (f, "#C Max active cells %d\n", s->max_active);
+	fprintf (f, "#C Glider count at accept %d\n", s->glider_count);
+	
+	for (st = s->tiles; st < s->tiles + s->n_tiles; st++) {
+		fprintf(f, "#P %d %d\n", st->xpos, st->ypos);
+		
+		int x, y;
+		
+		for(y=0; y<TILE_HEIGHT; y++) {
+			for(x=0; x<TILE_WIDTH; x++) {
+				char c = '.';
+				cellvalue v = ((st->bit0 [y] >> x) & 1) | (((st->bit1 [y] >> x) & 1) << 1);
+				
+				if((st->active [y] >> x) & 1)
+					c = '@';
+				
+				if(v == ON)
+					c = '*';
+				else if(v != OFF)
+					c = '?';
+				
+				fputc(c, f);
+			}
+			fputc('\n', f);
+		}
+	}
+}
+
+// Results stream.
+// With -o, all results go to one append-only file instead of one file per solution. The file
+// starts with the #S lines, which are the same for every solution, followed by the rest of each
+// result file, one after another. A second file, with ".idx" added to the name, has a
+// result_index_entry for each solution. extractresults turns them back into result files.
+
+#ifdef _WIN32
+#define ftell64 _ftelli64
+#define fseek64 _fseeki64
+#else
+#define ftell64 ftello
+#define fseek64 fseeko
+#endif
+
+#define RESULTS_STREAM_BUFFER_SIZE (1 << 20)
+
+static char *index_file_name (const char *stream_name)
+{
+	char *name = malloc (strlen (stream_name) + 5);
+	if (!name)
+	{
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
+	}
+	
+	sprintf (name, "%s.idx", stream_name);
+	return name;
+}
+
+static void open_results_stream ()
+{
+	char *name = index_file_name (results_stream_name);
+	
+	results_stream = fopen (results_stream_name, "wb");
+	if (!results_stream)
+	{
+		perror (results_stream_name);
+		exit (-1);
+	}
+	
+	results_index = fopen (name, "wb");
+	if (!results_index)
+	{
+		perror (name);
+		exit (-1);
+	}
+	
+	free (name);
+	setvbuf (results_stream, NULL, _IOFBF, RESULTS_STREAM_BUFFER_SIZE);
+	write_result_params (results_stream);
+	
+	// The first line of each result, so that extractresults can write the same result files
+	if (compact_results)
+		fprintf (results_stream, "#C Search made using %s, %s\n", program_name, version_string);
+}
+
+static void stop_result_writer ();
+
+static void close_results_stream ()
+{
+	stop_result_writer ();
+	
+	if (results_stream)
+	{
+		fclose (results_stream);
+		fclose (results_index);
+		results_stream = results_index = NULL;
+	}
+}
+
+static void add_stream_index_entry (int id, uint64_t offset, uint64_t end, int accept_gen, int max_active, int glider_count)
+{
+	result_index_entry e;
+	
+	memset (&e, 0, sizeof e);
+	e.id = id;
+	e.length = (uint32_t) (end - offset);
+	e.offset = offset;
+	e.accept_gen = accept_gen;
+	e.glider_count = glider_count;
+	e.max_active = max_active;
+	e.format = compact_results ? RESULT_FORMAT_COMPACT : RESULT_FORMAT_TEXT;
+	
+	if (fwrite (&e, sizeof e, 1, results_index) != 1)
+	{
+		perror (results_stream_name);
+		exit (-1);
+	}
+}
+
+#if MAX_LISTED_ACTIVATIONS > COMPACT_MAX_ACTIVATIONS
+#error "Compact result records can't hold all activation generations"
+#endif
+
+// Bounding box of the cells that aren't '.' in the result text. NO if there are none.
+static int snapshot_tile_bounds (const snapshot_tile *st, int *left, int *right, int *top, int *bottom)
+{
+	TILE_WORD cols = 0;
+	int y;
+	
+	*top = TILE_HEIGHT;
+	*bottom = -1;
+	
+	for (y = 0; y < TILE_HEIGHT; y++)
+	{
+		TILE_WORD set = st->bit0 [y] | st->bit1 [y] | st->active [y];
+		if (set)
+		{
+			if (y < *top)
+				*top = y;
+			*bottom = y;
+			cols |= set;
+		}
+	}
+	
+	if (!cols)
+		return NO;
+	
+	*left = __builtin_ctzll ((uint64_t) cols);
+	*right = 63 - __builtin_clzll ((uint64_t) cols);
+	return YES;
+}
+
+static int snapshot_cell_code (const snapshot_tile *st, int x, int y)
+{
+	cellvalue v = ((st->bit0 [y] >> x) & 1) | (((st->bit1 [y] >> x) & 1) << 1);
+	
+	if (v == ON)
+		return COMPACT_CELL_ON;
+	else if (v != OFF)
+		return COMPACT_CELL_UNKNOWN;
+	else if ((st->active [y] >> x) & 1)
+		return COMPACT_CELL_ACTIVE;
+	else
+		return COMPACT_CELL_OFF;
+}
+
+// A compact record instead of the result text, see resultstream.h
+static void write_compact_result (FILE *f, const result_snapshot *s)
+{
+	static uint8_t cells [(TILE_WIDTH * TILE_HEIGHT * 2 + 7) / 8];
+	compact_result_header h;
+	const snapshot_tile *st;
+	
+	memset (&h, 0, sizeof h);
+	h.accept_gen = s->accept_gen;
+	h.max_active = s->max_active;
+	h.glider_count = s->glider_count;
+	h.act_count = s->act_count;
+	memcpy (h.act_gen, s->act_gen, s->act_count * sizeof (int32_t));
+	h.tile_width = TILE_WIDTH;
+	h.tile_height = TILE_HEIGHT;
+	h.n_tiles = s->n_tiles;
+	fwrite (&h, sizeof h, 1, f);
+	
+	for (st = s->tiles; st < s->tiles + s->n_tiles; st++)
+	{
+		compact_tile_header th;
+		int left, right, top, bottom;
+		int x, y, n = 0;
+		
+		memset (&th, 0, sizeof th);
+		th.xpos = st->xpos;
+		th.ypos = st->ypos;
+		
+		if (!snapshot_tile_bounds (st, &left, &right, &top, &bottom))
+		{
+			fwrite (&th, sizeof th, 1, f);
+			continue;
+		}
+		
+		th.left = left;
+		th.top = top;
+		th.width = right - left + 1;
+		th.height = bottom - top + 1;
+		fwrite (&th, sizeof th, 1, f);
+		
+		memset (cells, 0, (th.width * th.height * 2 + 7) / 8);
+		for (y = top; y <= bottom; y++)
+			for (x = left; x <= right; x++, n++)
+				cells [n / 4] |= snapshot_cell_code (st, x, y) << (2 * (n % 4));
+		
+		fwrite (cells, 1, (n + 3) / 4, f);
+	}
+}
+
+static void add_stream_result (const result_snapshot *s)
+{
+	if (!results_stream)
+		open_results_stream ();
+	
+	uint64_t offset = ftell64 (results_stream);
+	if (compact_results)
+		write_compact_result (results_stream, s);
+	else
+		write_result_body (results_stream, s);
+	add_stream_index_entry (s->id, offset, ftell64 (results_stream), s->accept_gen, s->max_active, s->glider_count);
+}
+
+static void result_file_name (char *name, size_t size, int n)
+{
+	if (new_result_naming)
+		snprintf(name, size, "result%06d.out", n);
+	else
+		snprintf(name, size, "result%06d-4.out", n);
+}
+
+// A parallel worker's results are renamed in order once all earlier generations are done
+static void worker_result_file_name (char *name, size_t size, int gen, int n)
+{
+	snprintf(name, size, "gen%03d-result%06d.tmp", gen, n);
+}
+
+static void worker_stream_name (char *name, size_t size, int gen)
+{
+	snprintf(name, size, "gen%03d-results.tmp", gen);
+}
+
+static void worker_deferred_file_name (char *name, size_t size, int gen)
+{
+	snprintf(name, size, "gen%03d-deferred.txt", gen);
+}
+
+static void write_result (const result_snapshot *s)
+{
+	if (results_stream_name)
+		add_stream_result (s);
+	else
+	{
+		char name[40];
+		
+		if (s->worker_gen >= 0)
+			worker_result_file_name (name, sizeof name, s->worker_gen, s->id);
 		else
+			result_file_name (name, sizeof name, s->id);
+		
+		FILE *f = fopen(name, "w");
+		if(f) {
+			write_result_params (f);
+			write_result_body (f, s);
+			fclose(f);
+		} else perror(name);
+	}
+}
+
+// Result writer thread.
+// Solutions often come in bursts, and the search shouldn't wait for the disk meanwhile.
+// bellman_found_solution puts a snapshot of each solution in a queue, and the writer
+// thread writes them in order. The search only waits when the queue is full.
+// The thread is started with the first solution, so worker processes are forked
+// without it, and stop_result_writer writes what is left in the queue.
+
+#define RESULT_QUEUE_SIZE 64
+
+static result_snapshot *result_queue [RESULT_QUEUE_SIZE];
+static int result_queue_first = 0, result_queue_cnt = 0;
+static int result_writer_started = NO, result_writer_stopping = NO;
+static pthread_t result_writer;
+static pthread_mutex_t result_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t result_queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t result_queue_not_full = PTHREAD_COND_INITIALIZER;
+
+static void *result_writer_main (void *arg)
+{
+	(void) arg;
+	
+	for (;;)
+	{
+		pthread_mutex_lock (&result_queue_lock);
+		while (result_queue_cnt == 0 && !result_writer_stopping)
+			pthread_cond_wait (&result_queue_not_empty, &result_queue_lock);
+		
+		if (result_queue_cnt == 0)
+		{
+			pthread_mutex_unlock (&result_queue_lock);
+			return NULL;
+		}
+		
+		result_snapshot *s = result_queue [result_queue_first];
+		result_queue_first = (result_queue_first + 1) % RESULT_QUEUE_SIZE;
+		result_queue_cnt--;
+		int more = (result_queue_cnt > 0);
+		pthread_cond_signal (&result_queue_not_full);
+		pthread_mutex_unlock (&result_queue_lock);
+		
+		write_result (s);
+		free (s);
+		
+		// Keep the stream readable while the search goes on, once a burst is written
+		if (!more && results_stream)
+		{
+			fflush (results_stream);
+			fflush (results_index);
+		}
+	}
+}
+
+static void queue_result (result_snapshot *s)
+{
+	pthread_mutex_lock (&result_queue_lock);
+	
+	if (!result_writer_started)
+	{
+		if (pthread_create (&result_writer, NULL, result_writer_main, NULL) != 0)
+		{
+			fprintf (stderr, "Can't start the result writer thread\n");
+			exit (-1);
+		}
+		result_writer_started = YES;
+	}
+	
+	while (result_queue_cnt == RESULT_QUEUE_SIZE)
+		pthread_cond_wait (&result_queue_not_full, &result_queue_lock);
+	
+	result_queue [(result_queue_first + result_queue_cnt) % RESULT_QUEUE_SIZE] = s;
+	result_queue_cnt++;
+	pthread_cond_signal (&result_queue_not_empty);
+	pthread_mutex_unlock (&result_queue_lock);
+}
+
+static void stop_result_writer ()
+{
+	if (!result_writer_started)
+		return;
+	
+	pthread_mutex_lock (&result_queue_lock);
+	result_writer_stopping = YES;
+	pthread_cond_signal (&result_queue_not_empty);
+	pthread_mutex_unlock (&result_queue_lock);
+	
+	pthread_join (result_writer, NULL);
+	result_writer_started = NO;
+	result_writer_stopping = NO;
+}
+
+// Checksum of a solution for benchmark runs. The cells are added up, so it doesn't depend
+// on the tile size, and the checksums of all solutions are added up, so their order doesn't matter.
+static uint64_t snapshot_checksum (const result_snapshot *s)
+{
+	const snapshot_tile *st;
+	uint64_t sum = 0;
+	int y;
+	
+	for (st = s->tiles; st < s->tiles + s->n_tiles; st++)
+		for (y = 0; y < TILE_HEIGHT; y++)
+		{
+			TILE_WORD set = st->bit0 [y] | st->bit1 [y] | st->active [y];
+			while (set)
+			{
+				int x = __builtin_ctzll ((uint64_t) set);
+				set &= set - 1;
+				sum += splitmix64 (((uint64_t) (uint32_t) (st->xpos + x) << 32) ^ ((uint64_t) (uint32_t) (st->ypos + y) << 2) ^ snapshot_cell_code (st, x, y));
+			}
+		}
+	
+	return splitmix64 (sum ^ (uint64_t) s->accept_gen);
+}
+
+static void bellman_found_solution (int accept_gen, int max_active, int glider_count, int act_count, int act_gen [])
+{
+	solcount++;
+	last_sol_time = time (NULL);
+	
+	if (worker_gen >= 0)
+		printf ("--- Found solution %d in generation %d, accepted at gen %d, max active cells: %d\n", solcount, worker_gen, accept_gen, max_active);
+	else
+		printf ("--- Found solution %d, accepted at gen %d, max active cells: %d\n", solcount, accept_gen, max_active);
+	printf ("      Gliders: %d, activations at gen ", glider_count);
+	print_activation_gens (stdout, act_count, act_gen);
+	
+	result_snapshot *s = take_result_snapshot (accept_gen, max_active, glider_count, act_count, act_gen);
+	if (bench_file_name)
+		solution_checksum += snapshot_checksum (s);
+	queue_result (s);
+	
+	if (worker_gen >= 0)
+		fflush (stdout);
+}
+
+typedef enum {FILTER_MATCH_NO, FILTER_MATCH_YES, FILTER_MATCH_UNKNOWN} filter_match;
+
+// Unlike FILTER_MISMATCH, which counts unknown cells as a mismatch, this only
+// says NO when some known cell differs from a cell the filter cares about
+static filter_match compare_filter_tile (const tile *filter, const tile *pattern)
+{
+	TILE_WORD mismatch = 0;
+	TILE_WORD unknown = 0;
+
+	int y;
+	
+	if (pattern)
+		for (y = 0; y < TILE_HEIGHT; y++)
+		{
+			mismatch |= (filter->bit0 [y] ^ pattern->bit0 [y]) & ~(filter->bit1 [y] | pattern->bit1 [y]);
+			unknown |= ~filter->bit1 [y] & pattern->bit1 [y];
+		}
+	else
+		for (y = 0; y < TILE_HEIGHT; y++)
+			mismatch |= filter->bit0 [y] & ~filter->bit1 [y];
+	
+	if (mismatch)
+		return FILTER_MATCH_NO;
+	else if (unknown)
+		return FILTER_MATCH_UNKNOWN;
+	else
+		return FILTER_MATCH_YES;
+}
+
+// Compare generation g of the evolving universe against the filter for that generation,
+// which is attached to the tiles of the generation before it
+static filter_match test_filter (generation *g)
+{
+	universe *u = g->u;
+	filter_match result = FILTER_MATCH_YES;
+	
+	if (g == u->gens)
+		return result;
+	
+	tile *t, *tp;
+	for (t = g->tiles + u->used_lo, tp = t - u->ntiles; t < g->tiles + u->used_hi; t++, tp++)
+		if (tp->filter)
+		{
+			filter_match m = compare_filter_tile (tp->filter, t);
+			if (m == FILTER_MATCH_NO)
+				return m;
+			else if (m == FILTER_MATCH_UNKNOWN)
+				result = m;
+		}
+	
+	return result;
+}
+
+static int verify_static_is_stable ()
+{
+	// TODO: check only the neighbourhood of the cell we just modified!
+	
+	tile *t;
+	for(t = u_static->first->all_first; t; t = t->all_next)
+	{
+		evolve_result res = tile_stabilise_3state (t, t->next);
+		if (res & ABORT)
 			return NO;
+	}
+	
+	return YES;
+}
+
+// Nogood database.
+// Some prunes only depend on the static cells within a known distance of the cells that caused
+// them, whatever the rest of the static pattern turns out to be: an unstable static cell, and
+// an active or changed forbidden cell before the first activation is allowed, as no solution
+// can be accepted and no glider taken out of the pattern before then. The decided static cells
+// within that distance are stored as a nogood, and any later decision that completes a stored
+// nogood is pruned straight away, without evolving the pattern again.
+// The database is bounded: new nogoods overwrite the oldest ones, and each static cell value
+// only indexes the latest few nogoods it is part of.
+
+#define MAX_NOGOOD_CELLS 16
+#define NOGOOD_POOL_SIZE (1 << 16)
+#define NOGOOD_INDEX_SIZE (1 << 16)
+#define NOGOOD_INDEX_WAYS 4
+
+typedef struct {
+	uint32_t id;
+	int n_cells;
+	int x [MAX_NOGOOD_CELLS], y [MAX_NOGOOD_CELLS];
+	cellvalue v [MAX_NOGOOD_CELLS];
+} nogood;
+
+static nogood *nogoods = NULL;
+static uint32_t nogood_index [NOGOOD_INDEX_SIZE] [NOGOOD_INDEX_WAYS];
+
+// Zobrist style key of one decided static cell. The keys of all decided cells are xored
+// together into decided_hash, which so identifies the static pattern whatever order its
+// cells were decided in.
+static uint64_t decided_cell_key (int i)
+{
+	uint64_t k = ((uint64_t) (uint32_t) (decided_tile [i]->xpos + decided_x [i]) << 32) ^ ((uint64_t) (uint32_t) (decided_tile [i]->ypos + decided_y [i]) << 2) ^ decided_v [i];
+	return splitmix64 (k);
+}
+
+static void add_decided_cell (tile *t, int x, int y, cellvalue v)
+{
+	if (decided_cnt >= MAX_DECIDED_CELLS)
+	{
+		fprintf (stderr, "Decided cell list overflow\n");
+		assert (0);
+	}
+	
+	// Same wrapping as tile_set_cell
+	decided_tile [decided_cnt] = t;
+	decided_x [decided_cnt] = ((unsigned int) x) % TILE_WIDTH;
+	decided_y [decided_cnt] = ((unsigned int) y) % TILE_HEIGHT;
+	decided_v [decided_cnt] = v;
+	decided_hash ^= decided_cell_key (decided_cnt);
+	decided_cnt++;
+}
+
+// Forget the decided cells from cnt on. The cells themselves are reset by the caller.
+static void drop_decided_cells (int cnt)
+{
+	while (decided_cnt > cnt)
+	{
+		decided_cnt--;
+		decided_hash ^= decided_cell_key (decided_cnt);
+	}
+}
+
+static cellvalue static_cell (int x, int y)
+{
+	tile *t = generation_find_tile (u_static->first, x, y, 0);
+	return t ? tile_get_cell (t, x, y) : OFF;
+}
+
+static uint32_t *nogood_bucket (int x, int y, cellvalue v)
+{
+	uint32_t h = ((uint32_t) x * 0x9e3779b1) ^ ((uint32_t) y * 0x85ebca77) ^ ((uint32_t) v * 0xc2b2ae3d);
+	h ^= h >> 15;
+	return nogood_index [h & (NOGOOD_INDEX_SIZE - 1)];
+}
+
+static const nogood *nogood_by_id (uint32_t id)
+{
+	const nogood *ng = &nogoods [id & (NOGOOD_POOL_SIZE - 1)];
+	return (id != 0 && ng->id == id) ? ng : NULL;
+}
+
+// Store the decided static cells within distance r of any of the n cells at (x [], y []) as a nogood
+static void learn_nogood (int n, const int *x, const int *y, int r)
+{
+	if (!nogoods)
+	{
+		nogoods = calloc (NOGOOD_POOL_SIZE, sizeof *nogoods);
+		if (!nogoods)
+		{
+			fprintf (stderr, "Out of memory\n");
+			exit (-1);
+		}
+	}
+	
+	nogood *ng = &nogoods [(nogood_cnt + 1) & (NOGOOD_POOL_SIZE - 1)];
+	int n_cells = 0;
+	int i, k;
+	
+	// The oldest nogood is overwritten
+	ng->id = 0;
+	
+	for (i = 0; i < decided_cnt; i++)
+	{
+		int dx = decided_tile [i]->xpos + decided_x [i];
+		int dy = decided_tile [i]->ypos + decided_y [i];
+		
+		for (k = 0; k < n; k++)
+			if (abs (dx - x [k]) <= r && abs (dy - y [k]) <= r)
+				break;
+		
+		if (k == n)
+			continue;
+		
+		if (n_cells == MAX_NOGOOD_CELLS)
+		{
+			nogood_too_large++;
+			return;
+		}
+		
+		ng->x [n_cells] = dx;
+		ng->y [n_cells] = dy;
+		ng->v [n_cells] = decided_v [i];
+		n_cells++;
+	}
+	
+	// A prune that doesn't depend on any decision will just happen again
+	if (n_cells == 0)
+		return;
+	
+	ng->id = ++nogood_cnt;
+	ng->n_cells = n_cells;
+	
+	for (i = 0; i < n_cells; i++)
+	{
+		uint32_t *bucket = nogood_bucket (ng->x [i], ng->y [i], ng->v [i]);
+		for (k = 0; k < NOGOOD_INDEX_WAYS && nogood_by_id (bucket [k]); k++)
+			;
+		if (k == NOGOOD_INDEX_WAYS)
+		{
+			memmove (bucket, bucket + 1, (NOGOOD_INDEX_WAYS - 1) * sizeof *bucket);
+			k--;
+		}
+		bucket [k] = ng->id;
+	}
+}
+
+// Learn from an unstable static pattern. The last decision was stable before it was made,
+// so an unstable cell is next to one of its cells. A known cell that can't be stable, whatever
+// its unknown neighbours turn out to be, only depends on itself and its neighbours.
+static void learn_unstable_nogood ()
+{
+	int i, cx, cy, nx, ny;
+	
+	for (i = decided_latest; i < decided_cnt; i++)
+		for (cy = -1; cy <= 1; cy++)
+			for (cx = -1; cx <= 1; cx++)
+			{
+				int x = decided_tile [i]->xpos + decided_x [i] + cx;
+				int y = decided_tile [i]->ypos + decided_y [i] + cy;
+				cellvalue v = static_cell (x, y);
+				if (v == UNKNOWN_STABLE)
+					continue;
+				
+				int n_on = 0, n_unk = 0;
+				for (ny = y - 1; ny <= y + 1; ny++)
+					for (nx = x - 1; nx <= x + 1; nx++)
+						if (nx != x || ny != y)
+						{
+							cellvalue nv = static_cell (nx, ny);
+							if (nv == ON)
+								n_on++;
+							else if (nv == UNKNOWN_STABLE)
+								n_unk++;
+						}
+				
+				if ((v == OFF && n_on == 3 && n_unk == 0) || (v == ON && (n_on >= 4 || n_on + n_unk <= 1)))
+				{
+					learn_nogood (1, &x, &y, 1);
+					return;
+				}
+			}
+}
+
+// Transposition table.
+// Branches that place whole catalysts can reach the same static pattern in different orders,
+// for example when a library catalyst is made of smaller ones that are in the library too.
+// Deciding single cells can't, as the two branches of a decision always differ in that cell.
+// So only the catalyst placements look up and remember the patterns whose subtrees have been
+// searched. The table is bounded and direct mapped; a newer entry overwrites an older one.
+// With iterative deepening, the cell decisions use it too, to skip the subtrees that an
+// earlier pass with a smaller on-cell budget searched without ever hitting that budget.
+
+#define TRANSPOSITION_TABLE_SIZE (1 << 20)
+
+typedef struct {
+	uint64_t key;
+	int budget; // the on-cell budget the subtree was searched with
+	int complete; // the budget was never hit in the subtree, so it holds for any budget
+} transposition;
+
+static transposition *transpositions = NULL;
+
+// Besides the static pattern, the subtree depends on whether new on-cells are allowed, and on
+// the first generation to accept another solution at
+static uint64_t transposition_key (int allow_new_oncells, int first_next_sol_gen)
+{
+	uint64_t key = decided_hash ^ ((uint64_t) first_next_sol_gen * 0xd6e8feb86659fd93) ^ (allow_new_oncells ? 0xa0761d6478bd642f : 0);
+	return key ? key : 1;
+}
+
+static int is_transposition (uint64_t key)
+{
+	if (!transpositions)
+		return NO;
+	
+	transposition *tr = &transpositions [key & (TRANSPOSITION_TABLE_SIZE - 1)];
+	if (tr->key != key)
+		return NO;
+	if (tr->complete)
+		return YES;
+	if (tr->budget != added_on_budget)
+		return NO;
+	
+	// The skipped subtree hit the budget, so whatever contains it did too
+	budget_cuts++;
+	return YES;
+}
+
+static void add_transposition (uint64_t key, uint64_t budget_cuts_before)
+{
+	if (!transpositions)
+	{
+		transpositions = calloc (TRANSPOSITION_TABLE_SIZE, sizeof *transpositions);
+		if (!transpositions)
+		{
+			fprintf (stderr, "Out of memory\n");
+			exit (-1);
+		}
+	}
+	
+	transposition *tr = &transpositions [key & (TRANSPOSITION_TABLE_SIZE - 1)];
+	tr->key = key;
+	tr->budget = added_on_budget;
+	tr->complete = (budget_cuts == budget_cuts_before);
+}
+
+// The key doesn't hold current_single_gen, so a subtree searched for one strictly-gen-by-gen
+// generation must not be skipped in the next one
+static void clear_transpositions (void)
+{
+	if (transpositions)
+		memset (transpositions, 0, TRANSPOSITION_TABLE_SIZE * sizeof *transpositions);
+}
+
+// Deferred subtrees.
+// A subtree below a decision at level defer_subtree_level that takes more than defer_subtree_nodes
+// calls to bellman_recurse is given up on, and the search goes on with the next one. Its decision
+// prefix is queued, and written to deferred_file_name, one subtree per line:
+//   <single gen> <first next solution gen> <reported budget> <n cells> <n solutions> <x> <y> <value> ... <solution key> ...
+// The queued subtrees are searched to the end once the rest of the search is done, or, with
+// revisit-deferred set to 0, left for separate runs with -d. The solutions reported before a
+// subtree was given up on are remembered, so they are not reported again.
+
+#define DEFERRED_HASH_SIZE 4096
+#define MAX_SUBTREE_SOLUTIONS 256
+
+typedef struct deferred_subtree_s deferred_subtree;
+
+struct deferred_subtree_s {
+	uint64_t key;
+	int single_gen, first_next_sol_gen, reported_budget;
+	int n_cells;
+	int *cells; // x, y and value of each decided cell
+	int n_sols;
+	uint64_t *sol_keys;
+	deferred_subtree *next, *hashnext;
+};
+
+static deferred_subtree *deferred_first = NULL, *deferred_last = NULL;
+static deferred_subtree *deferred_hash [DEFERRED_HASH_SIZE];
+static int deferred_cnt = 0;
+static FILE *deferred_file = NULL;
+static char deferred_file_name [32] = "deferred.txt";
+
+static uint64_t subtree_node_limit = 0; // 0 when no subtree is timed
+static int deferring = NO;
+static int decision_level = 0;
+static uint64_t subtree_sol_keys [MAX_SUBTREE_SOLUTIONS];
+static int subtree_sol_cnt = 0;
+static const deferred_subtree *revisited = NULL;
+
+// The same static pattern is a different subtree in each strictly-gen-by-gen generation
+static uint64_t deferral_key (uint64_t key)
+{
+	return key ^ ((uint64_t) (current_single_gen + 1) * 0x8ebc6af09c88c6e3);
+}
+
+static uint64_t solution_key (int accept_gen)
+{
+	return decided_hash ^ ((uint64_t) (accept_gen + 1) * 0x589965cc75374cc3);
+}
+
+static int is_deferred (uint64_t key)
+{
+	deferred_subtree *d;
+	for (d = deferred_hash [key & (DEFERRED_HASH_SIZE - 1)]; d; d = d->hashnext)
+		if (d->key == key)
+			return YES;
+	
+	return NO;
+}
+
+// Check if a solution was reported before the subtree being revisited was deferred
+static int is_reported_solution (uint64_t sol_key)
+{
+	int i;
+	if (revisited)
+		for (i = 0; i < revisited->n_sols; i++)
+			if (revisited->sol_keys [i] == sol_key)
+				return YES;
+	
+	return NO;
+}
+
+// Remember a solution reported in the timed subtree. A subtree whose solutions don't fit
+// is searched to the end right away instead.
+static void note_subtree_solution (uint64_t sol_key)
+{
+	if (!subtree_node_limit)
+		return;
+	
+	subtree_sol_keys [subtree_sol_cnt++] = sol_key;
+	if (subtree_sol_cnt == MAX_SUBTREE_SOLUTIONS)
+		subtree_node_limit = 0;
+}
+
+static void *deferred_alloc (size_t n, size_t size)
+{
+	void *p = calloc (n ? n : 1, size);
+	if (!p)
+	{
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
+	}
+	
+	return p;
+}
+
+static deferred_subtree *queue_deferred_subtree (uint64_t key, int single_gen, int first_next_sol_gen, int reported_budget, int n_cells, int n_sols)
+{
+	deferred_subtree *d = deferred_alloc (1, sizeof *d);
+	
+	d->key = key;
+	d->single_gen = single_gen;
+	d->first_next_sol_gen = first_next_sol_gen;
+	d->reported_budget = reported_budget;
+	d->n_cells = n_cells;
+	d->cells = deferred_alloc (3 * n_cells, sizeof *d->cells);
+	d->n_sols = n_sols;
+	d->sol_keys = deferred_alloc (n_sols, sizeof *d->sol_keys);
+	
+	if (deferred_last)
+		deferred_last->next = d;
+	else
+		deferred_first = d;
+	deferred_last = d;
+	
+	d->hashnext = deferred_hash [key & (DEFERRED_HASH_SIZE - 1)];
+	deferred_hash [key & (DEFERRED_HASH_SIZE - 1)] = d;
+	
+	deferred_cnt++;
+	return d;
+}
+
+// Add a queued subtree to deferred_file_name
+static void write_deferred_subtree (const deferred_subtree *d)
+{
+	int i;
+	
+	if (!deferred_file)
+	{
+		deferred_file = fopen (deferred_file_name, "w");
+		if (!deferred_file)
+		{
+			perror (deferred_file_name);
+			exit (-1);
+		}
+	}
+	
+	fprintf (deferred_file, "%d %d %d %d %d", d->single_gen, d->first_next_sol_gen, d->reported_budget, d->n_cells, d->n_sols);
+	for (i = 0; i < d->n_cells; i++)
+		fprintf (deferred_file, " %d %d %d", d->cells [3 * i], d->cells [3 * i + 1], d->cells [3 * i + 2]);
+	for (i = 0; i < d->n_sols; i++)
+		fprintf (deferred_file, " %016" PRIx64, d->sol_keys [i]);
+	fprintf (deferred_file, "\n");
+	fflush (deferred_file);
+}
+
+// Queue the subtree below the current decided cells
+static void defer_subtree (uint64_t key, int first_next_sol_gen)
+{
+	deferred_subtree *d = queue_deferred_subtree (key, current_single_gen, first_next_sol_gen, reported_budget, decided_cnt, subtree_sol_cnt);
+	int i;
+	
+	for (i = 0; i < decided_cnt; i++)
+	{
+		d->cells [3 * i] = decided_tile [i]->xpos + decided_x [i];
+		d->cells [3 * i + 1] = decided_tile [i]->ypos + decided_y [i];
+		d->cells [3 * i + 2] = decided_v [i];
+	}
+	
+	memcpy (d->sol_keys, subtree_sol_keys, subtree_sol_cnt * sizeof *d->sol_keys);
+	write_deferred_subtree (d);
+}
+
+// Queue the subtrees listed in a file written by write_deferred_subtree
+static void load_deferred_subtrees (const char *filename)
+{
+	FILE *f = fopen (filename, "r");
+	if (!f)
+	{
+		perror (filename);
+		exit (-1);
+	}
+	
+	int single_gen, first_next_sol_gen, reported_budget, n_cells, n_sols, i;
+	
+	while (fscanf (f, "%d %d %d %d %d", &single_gen, &first_next_sol_gen, &reported_budget, &n_cells, &n_sols) == 5)
+	{
+		if (n_cells < 0 || n_cells > MAX_DECIDED_CELLS || n_sols < 0 || n_sols > MAX_SUBTREE_SOLUTIONS)
+		{
+			fprintf (stderr, "Bad deferred subtree in %s\n", filename);
+			exit (-1);
+		}
+		
+		deferred_subtree *d = queue_deferred_subtree (0, single_gen, first_next_sol_gen, reported_budget, n_cells, n_sols);
+		
+		for (i = 0; i < 3 * n_cells; i++)
+			if (fscanf (f, "%d", &d->cells [i]) != 1)
+			{
+				fprintf (stderr, "Bad deferred subtree in %s\n", filename);
+				exit (-1);
+			}
+		
+		for (i = 0; i < n_sols; i++)
+			if (fscanf (f, "%" SCNx64, &d->sol_keys [i]) != 1)
+			{
+				fprintf (stderr, "Bad deferred subtree in %s\n", filename);
+				exit (-1);
+			}
+	}
+	
+	fclose (f);
+}
+
+typedef enum {NOGOOD_ACTIVE_CELL, NOGOOD_TOO_MANY_ACTIVE_CELLS, NOGOOD_FORBIDDEN_CELL} nogood_cause;
+
+// Learn from a prune caused by known active cells, or a known change to a forbidden cell, in
+// generation g, which is generation gen of the pattern. Only done before the first activation is
+// allowed. At min_first_act_gen itself, an active cell is only pruned in strictly-gen-by-gen mode
+// because of current_single_gen, which the database doesn't know about. A cell in generation gen
+// depends on the static cells up to gen + 1 cells away.
+static void learn_evolving_nogood (generation *g, int gen, nogood_cause cause)
+{
+	if (gen >= min_first_act_gen)
+		return;
+	
+	int want = (cause == NOGOOD_TOO_MANY_ACTIVE_CELLS) ? max_act_cells + 1 : 1;
+	int x [MAX_NOGOOD_CELLS], y [MAX_NOGOOD_CELLS];
+	int n = 0;
+	
+	if (want > MAX_NOGOOD_CELLS)
+		return;
+	
+	universe *u = g->u;
+	tile *t;
+	int row;
+	
+	for (t = g->tiles + u->used_lo; t < g->tiles + u->used_hi && n < want; t++)
+	{
+		tile *stable = (tile *) t->auxdata;
+		if (!stable)
+			continue;
+		
+		tile *forbidden = (tile *) stable->auxdata;
+		if (cause == NOGOOD_FORBIDDEN_CELL && !forbidden)
+			continue;
+		
+		stable_words *sw = get_stable_words (stable);
+		
+		for (row = 0; row < TILE_HEIGHT && n < want; row++)
+		{
+			TILE_WORD bit0s = sw->rows [row + 1].c0, bit1s = sw->rows [row + 1].c1;
+			TILE_WORD was0now1 = (~bit0s & ~bit1s) & (t->bit0 [row] & ~t->bit1 [row]);
+			TILE_WORD was1now0 = (bit0s & ~bit1s) & (~t->bit0 [row] & ~t->bit1 [row]);
+			TILE_WORD cells = was0now1 | was1now0;
+			
+			if (cause == NOGOOD_FORBIDDEN_CELL)
+				cells &= forbidden->bit0 [row];
+			else
+				cells &= sw->set_mask [row];
+			
+			for (; cells && n < want; cells &= cells - 1)
+			{
+				x [n] = t->xpos + __builtin_ffsll (cells) - 1;
+				y [n] = t->ypos + row;
+				n++;
+			}
+		}
+	}
+	
+	if (n == want)
+		learn_nogood (n, x, y, gen + 1);
+}
+
+// Does the latest decision complete a stored nogood?
+static int matches_nogood ()
+{
+	int i, k, c;
+	
+	if (!nogoods)
+		return NO;
+	
+	nogood_lookups++;
+	
+	for (i = decided_latest; i < decided_cnt; i++)
+	{
+		uint32_t *bucket = nogood_bucket (decided_tile [i]->xpos + decided_x [i], decided_tile [i]->ypos + decided_y [i], decided_v [i]);
+		
+		for (k = 0; k < NOGOOD_INDEX_WAYS; k++)
+		{
+			const nogood *ng = nogood_by_id (bucket [k]);
+			if (!ng)
+				continue;
+			
+			for (c = 0; c < ng->n_cells && static_cell (ng->x [c], ng->y [c]) == ng->v [c]; c++)
+				;
+			
+			if (c == ng->n_cells)
+				return YES;
+		}
+	}
+	
+	return NO;
+}
+
+// Forward declaration to allow mutual calls between bellman_choose_cells and bellman_recurse
+static void bellman_choose_cells (universe *u, generation *g, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen);
+
+typedef enum {PHASE_NOT_ACTIVATED_YET, PHASE_ACTIVE, PHASE_RESTORED_NOT_YIELDED, PHASE_RESTORED_YIELDED} evolution_phase;
+
+static int activation_gen [MAX_LISTED_ACTIVATIONS];
+
+static int bellman_recurse_node (universe *u, generation *g, int allow_new_oncells, int previous_first_gen_with_unknown_cells, int first_next_sol_gen)
+{
+	if (__atomic_load_n (&status_tick, __ATOMIC_RELAXED))
+	{
+		__atomic_store_n (&status_tick, NO, __ATOMIC_RELAXED);
+		print_prune_counters (NO);
+	}
+	
+	// A benchmark run stops when its node budget is used up
+	if (node_budget && recurse_nodes >= node_budget)
+		return NO;
+	
+	// Give up on a timed subtree that has taken too long, and unwind to its root
+	recurse_nodes++;
+	if (subtree_node_limit && recurse_nodes > subtree_node_limit)
+	{
+		deferring = YES;
+		return YES;
+	}
+		
+	// First make sure the static pattern is truly static
+	// Note that both a new static on-cell and a new static off-cell can cause the static pattern to become impossible to make stable
+	if (!verify_static_is_stable ())
+	{
+		prune_unstable++;
+		learn_unstable_nogood ();
+		return YES;
+	}
+	
+// REINTRODUCTION OF FIXED CATALYSTS
+//	if (!ver_cats (g))
+//		return YES;
+	
+	// Evolve any changes up to previous first gen with unknown cells
+	generation *ge;
+	generation *last_gen = &u->gens [u->n_gens - 1];
+	for(ge = u->gens; ge < last_gen; ge++)
+	{
+		if(ge->flags & CHANGED)
+		{
+			ge->flags &= ~CHANGED;
+			bellman_evolve_generation(ge);
+		}
+		
+		if ((int) ge->gen == previous_first_gen_with_unknown_cells)
+			break;
+	}
+	
+	PROFILE_GEN ((int) ge->gen);
+	
+	// If there are still unknown cells in the same generation as before, just skip and pick another static cell to define
+	if (!(ge->flags & HAS_UNKNOWN_CELLS))
+	{
+		// Now check that the evolving universe is behaving itself
+		
+		evolution_phase phase = PHASE_NOT_ACTIVATED_YET;
+		int current_actn_first_gen = -1;
+		int last_allowed_act_gen = max_last_act_gen;
+		int last_allowed_act_limited_by_window = NO;
+		int current_restoration_gen = -1;
+		int unfiltered_accept_gen = -1;
+		int max_n_active = 0;
+		int n_activations = 0;
+		
+		// Once the pattern has settled, every later generation looks the same as the settled one,
+		// so they are checked without being evolved. Their tiles are left as they are, still
+		// marked CHANGED where needed, and get evolved again when a later branch needs them.
+		generation *settled = NULL;
+		
+		for(ge = u->gens; ge < last_gen; ge++)
+		{
+			generation *gs = settled ? settled : ge;
+			PROFILE_GEN ((int) ge->gen);
+			
+			if (!settled)
+			{
+				// Escaping gliders are only looked for once the catalysts have been activated and restored,
+				// as they are hardly ever found while a reaction is going on, and not worth the time then
+				if (phase != PHASE_NOT_ACTIVATED_YET && ge->n_active == 0 && !(ge->flags & HAS_UNKNOWN_CELLS))
+					remove_escaping_gliders (ge);
+				
+				if (ge->flags & CHANGED)
+				{
+					ge->flags &= ~CHANGED;
+					bellman_evolve_generation(ge);
+				}
+				
+				// When we see the next generation with unknown cells, we skip and pick more static cells to define.
+				// Bellman used to go on with checking the generation here anyway. Which method is faster varies a lot with different search parameters.
+				// Ideally Bellman should pick the most efficient method itself, but in a first step this choice of behavious could be made a search
+				// parameter instead
+				if (ge->flags & HAS_UNKNOWN_CELLS)
+				{
+					// The cells counted as active are a lower bound until the rest of the generation is known,
+					// and if nothing may turn out to be active, the generation is known to be inactive.
+					// Prune on anything that already follows from that.
+					int gen = (int) ge->gen;
+					int surely_active = (ge->n_active > 0);
+					int surely_inactive = !surely_active && !(ge->flags & MAY_BE_ACTIVE);
+					
+					if (phase == PHASE_NOT_ACTIVATED_YET)
+					{
+						int last_first_act_gen = max_first_act_gen;
+						if (strictly_gen_by_gen)
+							last_first_act_gen = lowest_of (last_first_act_gen, current_single_gen);
+						
+						// If this generation is inactive, the next one is too late for the first activation
+						if (gen > last_first_act_gen || (surely_inactive && gen >= last_first_act_gen))
+						{
+							prune_no_acty_in_time++;
+							return YES;
+						}
+						
+						if (surely_active && (gen < min_first_act_gen || (strictly_gen_by_gen && gen < current_single_gen)))
+						{
+							prune_first_acty_too_early++;
+							learn_evolving_nogood (ge, gen, NOGOOD_ACTIVE_CELL);
+							return YES;
+						}
+					}
+					
+					if (max_act_cells != PARM_DISABLED && (int) ge->n_active > max_act_cells)
+					{
+						prune_too_many_act_cells++;
+						learn_evolving_nogood (ge, gen, NOGOOD_TOO_MANY_ACTIVE_CELLS);
+						return YES;
+					}
+					
+					// Known cells keep their values whatever the unknown cells turn out to be, so a known mismatch
+					// with the filter, or a known change to a forbidden cell, is there to stay
+					if (test_filter (ge) == FILTER_MATCH_NO)
+					{
+						if (phase == PHASE_RESTORED_NOT_YIELDED && surely_inactive && gen >= unfiltered_accept_gen)
+							prune_explicit_filter_filtered++;
+						else
+							prune_explicit_filter_prune++;
+						return YES;
+					}
+					
+					if (ge->flags & IN_FORBIDDEN_REGION)
+					{
+						prune_forbidden++;
+						learn_evolving_nogood (ge, gen, NOGOOD_FORBIDDEN_CELL);
+						return YES;
+					}
+					
+					if (surely_active && gen > last_allowed_act_gen)
+					{
+						if (last_allowed_act_limited_by_window)
+							prune_acty_window_too_long++;
+						else
+							prune_acty_too_late++;
+						
+						return YES;
+					}
+					
+					if (surely_active && max_cons_act_gens != PARM_DISABLED && phase == PHASE_ACTIVE && gen > current_actn_first_gen + max_cons_act_gens + 1)
+					{
+						prune_cons_acty_too_long++;
+						return YES;
+					}
+					
+					// Whether this generation is active or not, a solution has already been found and it is too
+					// late to look for another one. If it is inactive, the same goes for the next generation.
+					if (phase == PHASE_RESTORED_YIELDED && (gen > last_allowed_act_gen || (surely_inactive && gen >= last_allowed_act_gen)))
+					{
+						prune_no_cont_found++;
+						return YES;
+					}
+					
+					break;
+				}
+			}
+			
+			int gen = (int) ge->gen;
+			
+			// Check if first activation should have happened by now
+			if (phase == PHASE_NOT_ACTIVATED_YET && (gen > max_first_act_gen || (strictly_gen_by_gen && gen > current_single_gen)))
+			{
+				prune_no_acty_in_time++;
+				return YES;
+			}
+			
+			// Check for first activation
+			// Verify that it doesn't happen too early
+			if (phase == PHASE_NOT_ACTIVATED_YET && gs->n_active > 0)
+			{
+				if (gen < min_first_act_gen || (strictly_gen_by_gen && gen < current_single_gen))
+				{
+					prune_first_acty_too_early++;
+					learn_evolving_nogood (gs, gen, NOGOOD_ACTIVE_CELL);
+					return YES;
+				}
+				else
+				{
+					phase = PHASE_ACTIVE;
+					current_actn_first_gen = gen;
+					if (max_act_window_gens != PARM_DISABLED && last_allowed_act_gen > gen + max_act_window_gens - 1)
+					{
+						last_allowed_act_gen = gen + max_act_window_gens - 1;
+						last_allowed_act_limited_by_window = YES;
+					}
+					if (n_activations < MAX_LISTED_ACTIVATIONS)
+						activation_gen [n_activations++] = gen;
+				}
+			}
+			
+			// We wanted to test for too early or too late activation first to spot any difference between normal mode and strictly-gen-by-gen mode
+			// After that, test for too much activity first, for performance
+			if (max_act_cells != PARM_DISABLED && (int) gs->n_active > max_act_cells)
+			{
+				prune_too_many_act_cells++;
+				learn_evolving_nogood (gs, gen, NOGOOD_TOO_MANY_ACTIVE_CELLS);
+				return YES;
+			}
+			
+			max_n_active = highest_of (max_n_active, gs->n_active);
+			
+			// Check if all catalysts are restored and inactive after an ongoing activation
+			if (phase == PHASE_ACTIVE && gs->n_active == 0)
+			{
+				phase = PHASE_RESTORED_NOT_YIELDED;
+				current_restoration_gen = gen;
+				
+				if (accept1_inact_gens == PARM_DISABLED)
+					unfiltered_accept_gen = highest_of (current_restoration_gen + accept2_min_inact_gens - 1, current_actn_first_gen + accept2_act_inact_gens - 1);
+				else if (accept2_act_inact_gens == PARM_DISABLED)
+				 	unfiltered_accept_gen = current_restoration_gen + accept1_inact_gens - 1;
+				else
+					unfiltered_accept_gen = lowest_of (current_restoration_gen + accept1_inact_gens - 1, highest_of (current_restoration_gen + accept2_min_inact_gens - 1, current_actn_first_gen + accept2_act_inact_gens - 1));
+				
+				if (accept2_act_inact_gens != PARM_DISABLED)
+					unfiltered_accept_gen = lowest_of (unfiltered_accept_gen, highest_of (current_restoration_gen + accept2_min_inact_gens - 1, current_actn_first_gen + accept2_act_inact_gens - 1));
+			}
+			
+			// Check for reactivation. This could be before the previous activation was accepted as a solution,
+			// or it could be a search for further solutions if cont_after_accept is set. 
+			if ((phase == PHASE_RESTORED_NOT_YIELDED || phase == PHASE_RESTORED_YIELDED) && gs->n_active > 0)
+			{
+				phase = PHASE_ACTIVE;
+				current_actn_first_gen = gen;
+				if (n_activations < MAX_LISTED_ACTIVATIONS)
+					activation_gen [n_activations++] = gen;
+			}
+			
+			// Check for activity after all activity should have stopped
+			if (gs->n_active > 0 && gen > last_allowed_act_gen)
+			{
+				if (last_allowed_act_limited_by_window)
+					prune_acty_window_too_long++;
+				else
+					prune_acty_too_late++;
+				
+				return YES;
+			}
+			
+			// Note that if support is re-added for evaluating patterns with unknown evolving cells, this needs to be qualified with having no such cells
+			if (gs->flags & FILTER_MISMATCH)
+			{
+				// Consider it a prune or a filtering depending on if the filter is applied before or after the solution should have been accepted without the filter
+				if (phase == PHASE_RESTORED_NOT_YIELDED && gen >= unfiltered_accept_gen)
+					prune_explicit_filter_filtered++;
+				else
+					prune_explicit_filter_prune++;
+				return YES;
+			}
+			
+			if (gs->flags & IN_FORBIDDEN_REGION)
+			{
+				prune_forbidden++;
+				learn_evolving_nogood (gs, gen, NOGOOD_FORBIDDEN_CELL);
+				return YES;
+			}
+			
+			// Check if an ongoing activation has lasted too long without break
+			if (max_cons_act_gens != PARM_DISABLED && phase == PHASE_ACTIVE && gen > current_actn_first_gen + max_cons_act_gens + 1)
+			{
+				prune_cons_acty_too_long++;
+				return YES;
+			}
+			
+			// Check if all conditions for a solution are met
+			if (phase == PHASE_RESTORED_NOT_YIELDED)
+			{
+				int accept_gen = highest_of (unfiltered_accept_gen, u_filter->n_gens - 1);
+				
+				if (gen >= accept_gen)
+					phase = PHASE_RESTORED_YIELDED;
+				
+				if (gen == accept_gen && gen >= first_next_sol_gen)
+				{
+					// Filter out solutions that are too simple
+					if (filter_min_act_cells == PARM_DISABLED || max_n_active >= filter_min_act_cells)
+					{
+						uint64_t sol_key = solution_key (gen);
+						if (onlist_cnt > reported_budget && !is_reported_solution (sol_key))
+						{
+							bellman_found_solution (gen, max_n_active, count_gliders (gs) + gs->escaped_gliders, n_activations, activation_gen);
+							note_subtree_solution (sol_key);
+						}
+						prune_solution++;
+					}
+					else
+						prune_filter_too_few_act_cells++;
+					
+					if (cont_after_accept)
+						first_next_sol_gen = gen + 1;
+					else
+						return YES;
+				}
+			}
+			
+			// Check if we can stop looking for a solution in continue_after_accept mode
+			if (gen > last_allowed_act_gen && phase == PHASE_RESTORED_YIELDED)
+			{
+				prune_no_cont_found++;
+				return YES;
+			}
+			
+			// Stop adding new on-cells when it's too late to start a new activation and there is currently no ongoing activation
+			// This prevents a lot of irrelevant solutions with extra pixels that don't activate
+			if (gen > last_allowed_act_gen && (phase == PHASE_RESTORED_NOT_YIELDED || phase == PHASE_RESTORED_YIELDED))
+				allow_new_oncells = NO;
+			
+			if (!settled && ge->n_active == 0 && generation_is_settled (ge))
+				settled = ge;
+		}
+		
+		// There are no unknown cells left in any generation, just as if we got to the end of the pattern
+		if (settled)
+		{
+			if (max_results != PARM_DISABLED && solcount >= max_results)
+				return NO;
+			
+			got_to_end_of_pattern = YES;
+			return YES;
+		}
+	}
+	
+	if (max_results != PARM_DISABLED && solcount >= max_results)
+		return NO;
+	
+	bellman_choose_cells(u, g, allow_new_oncells, ge->gen, first_next_sol_gen);
+	return YES;
+}
+
+static int bellman_recurse (universe *u, generation *g, int allow_new_oncells, int previous_first_gen_with_unknown_cells, int first_next_sol_gen)
+{
+#ifdef PROFILE_SEARCH
+	profile_enter ();
+	int result = bellman_recurse_node (u, g, allow_new_oncells, previous_first_gen_with_unknown_cells, first_next_sol_gen);
+	profile_leave ();
+	return result;
+#else
+	return bellman_recurse_node (u, g, allow_new_oncells, previous_first_gen_with_unknown_cells, first_next_sol_gen);
+#endif
+}
+
+static int xy_symmetry(int x, int y, int* mirrorx_arr, int* mirrory_arr)
+{
+	mirrorx_arr[0] = x;
+	mirrory_arr[0] = y;
+	
+	switch(symmetry_type) {
+		case NONE:
+			return 1;
+		case HORIZ:
+			if(y == symmetry_ofs - y)
+				return 1;
+			
+			mirrorx_arr[1] = x;
+			mirrory_arr[1] = symmetry_ofs - y;
+			
+			return 2;
+			
+		case VERT:
+			if(x == symmetry_ofs - x)
+				return 1;
+			
+			mirrorx_arr[1] =  symmetry_ofs - x;
+			mirrory_arr[1] = y;
+			
+			return 2;
+			
+		default:
+			return 1;
+	}
+}
+
+
+static int distance_sq (int x1, int y1, int x2, int y2)
+{
+	return (x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1);
+}
+
+typedef enum {COMPL_OK, COMPL_FAILED_LOCAL_RECT, COMPL_FAILED_OVERALL_LOCALLY, COMPL_FAILED_TOO_MANY_RECTS, COMPL_FAILED_GLOBALLY} compl_result;
+
+typedef struct
+{
+	int xon;
+	int xoff;
+	int yon;
+	int yoff;
+	int oncnt;
+	int free_cells;
+	int compl_limit;
+} compl_box;
+
+static void compl_box_init (compl_box *cb, int free_cells, int compl_limit)
+{
+	cb->xon = 0;
+	cb->xoff = 0;
+	cb->yon = 0;
+	cb->yoff = 0;
+	cb->oncnt = 0;
+	cb->free_cells = free_cells;
+	cb->compl_limit = compl_limit;
+}
+
+static void compl_box_copy (const compl_box *src, compl_box *dst)
+{
+	dst->xon = src->xon;
+	dst->xoff = src->xoff;
+	dst->yon = src->yon;
+	dst->yoff = src->yoff;
+	dst->oncnt = src->oncnt;
+	dst->free_cells = src->free_cells;
+	dst->compl_limit = src->compl_limit;
+}
+
+static void compl_box_add_cell (compl_box *cb, int x, int y)
+{
+	if (cb->oncnt == 0)
+	{
+		cb->xon = x;
+		cb->xoff = x + 1;
+		cb->yon = y;
+		cb->yoff = y + 1;
+	}
+	else
+	{
+		cb->xon = lowest_of (cb->xon, x);
+		cb->xoff = highest_of (cb->xoff, x + 1);
+		cb->yon = lowest_of (cb->yon, y);
+		cb->yoff = highest_of (cb->yoff, y + 1);
+	}
+	
+	cb->oncnt++;
+}
+
+static void compl_box_merge (const compl_box *src, compl_box *dst)
+{
+	dst->xon = lowest_of (dst->xon, src->xon);
+	dst->xoff = highest_of (dst->xoff, src->xoff);
+	dst->yon = lowest_of (dst->yon, src->yon);
+	dst->yoff = highest_of (dst->yoff, src->yoff);
+	dst->oncnt += src->oncnt;
+}
+
+static int compl_box_size_compl (const compl_box *cb)
+{
+	int longside = highest_of (cb->xoff - cb->xon, cb->yoff - cb->yon);
+	int shortside = lowest_of (cb->xoff - cb->xon, cb->yoff - cb->yon);
+	
+	return 2 * longside + shortside;
+}
+
+static int compl_box_within_limit (const compl_box *cb)
+{
+	return (compl_box_size_compl (cb) + highest_of (0, cb->oncnt - cb->free_cells)) <= cb->compl_limit;
+}
+
+
+static int box_cnt;
+static compl_box temp_box [MAX_MAX_UNMERGED_LOCAL_RECTS];
+static int box_of_cell [MAX_MAX_ADDED_STATIC_ON];
+
+static void delete_compl_box (int del_ix, int new_cell_box)
+{
+	int cell_ix;
+	for (cell_ix = 0; cell_ix < onlist_cnt; cell_ix++)
+	{
+		if (box_of_cell [cell_ix] == del_ix)
+			box_of_cell [cell_ix] = new_cell_box;
+		if (box_of_cell [cell_ix] > del_ix)
+			box_of_cell [cell_ix]--;
+	}
+	
+	int box_ix;
+	for (box_ix = del_ix; box_ix < box_cnt - 1; box_ix++)
+		compl_box_copy (&temp_box [box_ix + 1], &temp_box [box_ix]);
+	
+	box_cnt--;
+}
+
+static compl_result test_compl_locally ()
+{
+	int max_compl = (max_local_rect_compl == PARM_DISABLED) ? max_overall_local_compl : max_local_rect_compl;
+	int free_cells = (max_local_rect_compl == PARM_DISABLED) ? LOCAL_COMPL_OVERALL_FREE_CELLS : LOCAL_RECT_FREE_CELLS;
+	int fail_code = (max_local_rect_compl == PARM_DISABLED) ? COMPL_FAILED_OVERALL_LOCALLY : COMPL_FAILED_LOCAL_RECT;
+	
+	box_cnt = 0;
+	
+	int obj_ix;
+	for (obj_ix = 0; obj_ix < onlist_cnt; obj_ix++)
+	{
+		box_of_cell [obj_ix] = -1;
+		
+		int ref_ix;
+		for (ref_ix = 0; ref_ix < obj_ix; ref_ix++)
+		{
+			int dist_sq = distance_sq (onlist_x [obj_ix], onlist_y [obj_ix], onlist_x [ref_ix], onlist_y [ref_ix]);
+			
+			if (dist_sq < min_rect_separation_sq)
+			{
+				if (box_of_cell [obj_ix] == -1)
+				{
+					// obj_ix cell was not yet in a box, but it is close to a cell in an existing box, so add it to that box
+					compl_box_add_cell (&temp_box [box_of_cell [ref_ix]], onlist_x [obj_ix], onlist_y [obj_ix]);
+					if (!compl_box_within_limit (&temp_box [box_of_cell [ref_ix]]))
+						return fail_code;
+					
+					box_of_cell [obj_ix] = box_of_cell [ref_ix];
+				}
+				else if (box_of_cell [obj_ix] != box_of_cell [ref_ix])
+				{
+					// obj_ix cell was already in a box, but it is also close to a cell in another box, so these boxes must be merged
+					
+					compl_box_merge (&temp_box [box_of_cell [obj_ix]], &temp_box [box_of_cell [ref_ix]]);
+					if (!compl_box_within_limit (&temp_box [box_of_cell [ref_ix]]))
+						return fail_code;
+					
+					delete_compl_box (box_of_cell [obj_ix], box_of_cell [ref_ix]);
+				}
+			}
+		}
+		
+		if (box_of_cell [obj_ix] == -1)
+		{
+			// obj_ix cell was not close to a cell in an existing box, so start a new box and put it there
+			if (box_cnt >= MAX_MAX_UNMERGED_LOCAL_RECTS)
+			{
+				fprintf (stderr, "Unmerged local rectangles buffer overflow\n");
+				exit (-1);
+			}
+			
+			compl_box_init (&temp_box [box_cnt], free_cells, max_compl);
+			compl_box_add_cell (&temp_box [box_cnt], onlist_x [obj_ix], onlist_y [obj_ix]);
+			box_of_cell [obj_ix] = box_cnt;
+			box_cnt++;
+		}
+	}
+	
+	// Here we should first try to merge boxes to reduce the number of boxes and/or the total complexity of them
+	
+	if (box_cnt > max_local_rects)
+		return COMPL_FAILED_TOO_MANY_RECTS;
+	
+	if (max_overall_local_compl != PARM_DISABLED)
+	{
+		int overall_compl = 0;
+		int box_ix;
+		for (box_ix = 0; box_ix < box_cnt; box_ix++)
+			overall_compl += compl_box_size_compl (&temp_box [box_ix]);
+		
+		overall_compl += highest_of (0, onlist_cnt - LOCAL_COMPL_OVERALL_FREE_CELLS);
+		if (overall_compl > max_overall_local_compl)
+			return COMPL_FAILED_OVERALL_LOCALLY;
+	}
+	
+	return COMPL_OK;
+}
+
+static compl_result test_compl ()
+{
+	if (max_local_rect_compl != PARM_DISABLED || max_overall_local_compl != PARM_DISABLED)
+	{
+		compl_result loc_result = test_compl_locally ();
+		if (loc_result != COMPL_OK)
+			return loc_result;
+	}
+	
+	if (max_global_compl != PARM_DISABLED)
+	{
+		compl_box_init (&temp_box [0], GLOBAL_COMPL_FREE_CELLS, max_global_compl);
+		
+		int cell_ix;
+		for (cell_ix = 0; cell_ix < onlist_cnt; cell_ix++)
+		{
+			compl_box_add_cell (&temp_box [0], onlist_x [cell_ix], onlist_y [cell_ix]);
+			if (!compl_box_within_limit (&temp_box [0]))
+				return COMPL_FAILED_GLOBALLY;
+		}
+	}
+		
+	return COMPL_OK;
+}
+
+
+#ifdef CHECK_CHOOSE_CELL
+
+// The original cell-by-cell version of choose_cell, kept to cross-check it.
+// Build with -DCHECK_CHOOSE_CELL to compare every choice made during a search.
+
+static int validate_xy_for_symmetry(int x, int y)
+{
+	switch(symmetry_type) {
+	case NONE:
+		return YES;
+	case HORIZ:
+		if(y >= symmetry_ofs - y)
+			return YES;
+		else
+			return NO;
+
+	case VERT:
+		if(x >= symmetry_ofs - x)
+			return YES;
+		else
+			return NO;
+
+	default:
+		return NO;
+	}
+}
+
+#define TRY(cdx, cdy)																										\
+	if(tile_get_cell(tp, x + cdx, y + cdy) == UNKNOWN_STABLE && validate_xy_for_symmetry(x + cdx, y + cdy) == YES) {	\
+		dx = cdx;																											\
+		dy = cdy;																											\
+		goto found;																											\
+	}
+
+static int choose_cell_by_scan (tile *t, tile *tp, int gen, int *cell_x, int *cell_y, int *cell_dx, int *cell_dy)
+{
+	int x, y, dx = 2, dy = 2;
+	uint64_t rows;
+	
+	// Only the rows with unknown cells need to be looked at.
+	// Look for direct predecessors first ...
+	
+	for(rows = t->unknown_rows; rows; rows &= rows - 1) {
+		y = __builtin_ffsll(rows) - 1;
+		TILE_WORD is_unk = t->bit1[y] & ~t->bit0[y];
+		for(x = 0; x < TILE_WIDTH; x++) {
+			if((is_unk >> x) & 1) {
+				assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
+				// Now look for an unknown-stable cell near it.
+				if((x == 0) || (x == TILE_WIDTH-1) || (y == 0) || (y == TILE_HEIGHT-1)) {
+					fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", gen, x, y);
+					assert(0);
+				}
+				
+				
+				TRY(0, 0);
+			}
+		}
+	}
+	
+	// ... then orthogonally adjacent cells ...
+	
+	for(rows = t->unknown_rows; rows; rows &= rows - 1) {
+		y = __builtin_ffsll(rows) - 1;
+		TILE_WORD is_unk = t->bit1[y] & ~t->bit0[y];
+		for(x = 0; x < TILE_WIDTH; x++) {
+			if((is_unk >> x) & 1) {
+				assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
+				// Now look for an unknown-stable cell near it.
+				if((x == 0) || (x == TILE_WIDTH-1) || (y == 0) || (y == TILE_HEIGHT-1)) {
+					fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", gen, x, y);
+					assert(0);
+				}
+				
+				
+				TRY(1, 0);
+				TRY(0, 1);
+				TRY(-1, 0);
+				TRY(0, -1);
+			}
+		}
+	}
+	
+	// ... then diagonally adjacent ones.
+	
+	for(rows = t->unknown_rows; rows; rows &= rows - 1) {
+		y = __builtin_ffsll(rows) - 1;
+		TILE_WORD is_unk = t->bit1[y] & ~t->bit0[y];
+		for(x = 0; x < TILE_WIDTH; x++) {
+			if((is_unk >> x) & 1) {
+				assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
+				// Now look for an unknown-stable cell near it.
+				if((x == 0) || (x == TILE_WIDTH-1) || (y == 0) || (y == TILE_HEIGHT-1)) {
+					fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", gen, x, y);
+					assert(0);
+				}
+				
+				
+				TRY(-1, -1);
+				TRY(-1, 1);
+				TRY(1, -1);
+				TRY(1, 1);
+			}
+		}
+	}
+		
+	return NO;
+	
+found:
+	*cell_x = x;
+	*cell_y = y;
+	*cell_dx = dx;
+	*cell_dy = dy;
+	return YES;
+}
+
+#endif
+
+// Cells of row y of tile tp (previous generation) that are UNKNOWN_STABLE and may be chosen
+// under the symmetry constraint. Rows outside the tile have no such cells.
+static TILE_WORD choosable_cells (tile *tp, int y)
+{
+	if (y < 0 || y >= TILE_HEIGHT)
+		return 0;
+	
+	TILE_WORD cells = tp->bit0 [y] & tp->bit1 [y];
+	
+	switch (symmetry_type)
+	{
+		case NONE:
+			return cells;
+		case HORIZ:
+			return (y >= symmetry_ofs - y) ? cells : 0;
+		case VERT:
+			if (symmetry_ofs <= 0)
+				return cells;
+			else if ((symmetry_ofs + 1) / 2 >= TILE_WIDTH)
+				return 0;
+			else
+				return cells & ~((((TILE_WORD) 1) << ((symmetry_ofs + 1) / 2)) - 1);
+		default:
+			return 0;
+	}
+}
+
+// Offsets from an unknown cell to the unknown-stable cell to branch on, in order of preference:
+// direct predecessors first, then orthogonally adjacent cells, then diagonally adjacent ones
+static const int choice_dx [9] = {0, 1, 0, -1, 0, -1, -1, 1, 1};
+static const int choice_dy [9] = {0, 0, 1, 0, -1, -1, 1, -1, 1};
+static const int choice_pass_end [3] = {1, 5, 9};
+
+// Find an UNKNOWN cell (x, y) in tile t, and an offset (dx, dy) to an unknown-stable cell next
+// to it in tile tp, which is the same tile in the previous generation. Within each pass of
+// choice_dx/choice_dy, the first unknown cell in row-major order that has a choosable neighbour
+// at any of the pass's offsets wins, with its first matching offset.
+// The neighbour words are built by shifting the choosable words of the rows above, at and below.
+static int choose_cell (tile *t, tile *tp, int gen, int *cell_x, int *cell_y, int *cell_dx, int *cell_dy)
+{
+	int pass;
+	int start = 0;
+	
+	for (pass = 0; pass < 3; pass++)
+	{
+		uint64_t rows;
+		for (rows = t->unknown_rows; rows; rows &= rows - 1)
+		{
+			int y = __builtin_ffsll (rows) - 1;
+			TILE_WORD is_unk = t->bit1 [y] & ~t->bit0 [y];
+			
+			TILE_WORD near [3];
+			near [0] = choosable_cells (tp, y - 1);
+			near [1] = choosable_cells (tp, y);
+			near [2] = choosable_cells (tp, y + 1);
+			
+			TILE_WORD at_offset [9];
+			TILE_WORD candidates = 0;
+			int k;
+			for (k = start; k < choice_pass_end [pass]; k++)
+			{
+				TILE_WORD w = near [choice_dy [k] + 1];
+				if (choice_dx [k] > 0)
+					w >>= 1;
+				else if (choice_dx [k] < 0)
+					w <<= 1;
+				
+				at_offset [k] = w & is_unk;
+				candidates |= at_offset [k];
+			}
+			
+			// Unknown cells on the edge of the tile are not handled. The first pass looks at
+			// every unknown cell up to the chosen one, so complain if one of them is on the edge.
+			if (pass == 0)
+			{
+				TILE_WORD edge = is_unk;
+				if (y != 0 && y != TILE_HEIGHT - 1)
+					edge &= ((TILE_WORD) 1) | (((TILE_WORD) 1) << (TILE_WIDTH - 1));
+				
+				if (candidates)
+				{
+					int cx = __builtin_ffsll (candidates) - 1;
+					if (cx < TILE_WIDTH - 1)
+						edge &= (((TILE_WORD) 1) << (cx + 1)) - 1;
+				}
+				
+				if (edge)
+				{
+					fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", gen, __builtin_ffsll (edge) - 1, y);
+					assert(0);
+				}
+			}
+			
+			if (candidates)
+			{
+				int x = __builtin_ffsll (candidates) - 1;
+				for (k = start; !((at_offset [k] >> x) & 1); k++)
+					;
+				
+				*cell_x = x;
+				*cell_y = y;
+				*cell_dx = choice_dx [k];
+				*cell_dy = choice_dy [k];
+				return YES;
+			}
+		}
+		
+		start = choice_pass_end [pass];
+	}
+	
+	return NO;
+}
+
+// Find the tile of cell (x, y), given relative to tile t, and make (x, y) relative to that tile.
+// Cells outside the evolving universe have no tile.
+static tile *resolve_cell (tile *t, int *x, int *y)
+{
+	while (t && *x < 0)
+	{
+		t = t->left;
+		*x += TILE_WIDTH;
+	}
+	while (t && *x >= TILE_WIDTH)
+	{
+		t = t->right;
+		*x -= TILE_WIDTH;
+	}
+	while (t && *y < 0)
+	{
+		t = t->up;
+		*y += TILE_HEIGHT;
+	}
+	while (t && *y >= TILE_HEIGHT)
+	{
+		t = t->down;
+		*y -= TILE_HEIGHT;
+	}
+	return t;
+}
+
+// Set static cell (x, y), relative to tp, and its mirror images to v as part of a catalyst
+// placement. Cells that already have the value are left alone. Fails if a cell has the other
+// value, or is still unknown when it must already be Off.
+static int place_cell (tile *tp, int x, int y, cellvalue v, int must_be_off)
+{
+	int xmirror[8], ymirror[8], n_sym, i;
+	
+	n_sym = xy_symmetry(x, y, xmirror, ymirror);
+	
+	for(i = 0; i < n_sym; i++)
+	{
+		int mx = xmirror [i];
+		int my = ymirror [i];
+		tile *t = resolve_cell (tp, &mx, &my);
+		tile *stable = t ? (tile *)t->auxdata : NULL;
+		cellvalue cur = stable ? tile_get_cell (stable, mx, my) : OFF;
+		
+		if (cur == UNKNOWN_STABLE && !must_be_off)
+		{
+			if (v == ON)
+			{
+				if (onlist_cnt >= MAX_MAX_ADDED_STATIC_ON)
+				{
+					fprintf (stderr, "On-cell list overflow\n");
+					assert (0);
+				}
+				
+				onlist_x [onlist_cnt] = xmirror [i];
+				onlist_y [onlist_cnt] = ymirror [i];
+				onlist_cnt++;
+			}
+			
+			tile_set_cell(t, mx, my, v);
+			tile_set_cell(stable, mx, my, v);
+			add_decided_cell (t, mx, my, v);
+		}
+		else if (cur != v)
+			return NO;
+	}
+	
+	return YES;
+}
+
+static void unplace_cells (int cnt)
+{
+	int i;
+	
+	for (i = cnt; i < decided_cnt; i++)
+	{
+		tile *t = decided_tile [i];
+		tile_set_cell(t, decided_x [i], decided_y [i], UNKNOWN_STABLE);
+		tile_set_cell((tile *)t->auxdata, decided_x [i], decided_y [i], UNKNOWN_STABLE);
+	}
+	
+	drop_decided_cells (cnt);
+}
+
+// Place catalyst c with the top left corner of its box at (x, y), relative to tp.
+// On failure some of its cells may already be set; the caller undoes them.
+static int place_catalyst (tile *tp, const catalyst *c, int x, int y)
+{
+	int cx, cy;
+	
+	// Most placements don't fit, so reject them on the row masks first where that's possible
+	if (tp->auxdata && x >= 0 && y >= 0 && x + c->wd <= TILE_WIDTH && y + c->ht <= TILE_HEIGHT &&
+		!catalyst_matches (c, (tile *)tp->auxdata, x, y))
+			return NO;
+	
+	for (cy = 0; cy < c->ht; cy++)
+		for (cx = 0; cx < c->wd; cx++)
+		{
+			TILE_WORD bit = ((TILE_WORD) 1) << cx;
+			int ok = YES;
+			
+			if (c->on_bits [cy] & bit)
+				ok = place_cell (tp, x + cx, y + cy, ON, NO);
+			else if (c->off_bits [cy] & bit)
+				ok = place_cell (tp, x + cx, y + cy, OFF, NO);
+			else if (c->must_off_bits [cy] & bit)
+				ok = place_cell (tp, x + cx, y + cy, OFF, YES);
+			
+			if (!ok)
+				return NO;
+		}
+	
+	return YES;
+}
+
+// Recurse below a decision. The subtrees below the decisions at level defer_subtree_level are
+// timed, and deferred if they take too long.
+static void recurse_subtree (universe *u, generation *gp, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen)
+{
+	decision_level++;
+	
+	if (decision_level != defer_subtree_level || defer_subtree_nodes == PARM_DISABLED || revisited)
+		bellman_recurse(u, gp, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+	else
+	{
+		uint64_t key = deferral_key (transposition_key (allow_new_oncells, first_next_sol_gen));
+		
+		if (is_deferred (key))
+			prune_deferred++;
+		else
+		{
+			subtree_node_limit = recurse_nodes + defer_subtree_nodes;
+			subtree_sol_cnt = 0;
+			
+			bellman_recurse(u, gp, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+			
+			subtree_node_limit = 0;
+			if (deferring)
+			{
+				defer_subtree (key, first_next_sol_gen);
+				deferring = NO;
+				prune_deferred++;
+			}
+		}
+	}
+	
+	decision_level--;
+}
+
+// Recurse with each library catalyst that fits with one of its On cells at (x, y), relative to tp
+static void place_catalysts (universe *u, generation *gp, tile *tp, int x, int y, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen)
+{
+	int i, k;
+	
+	for (i = 0; i < n_catalysts; i++)
+	{
+		const catalyst *c = &catalysts [i];
+		
+		for (k = 0; k < c->n_on; k++)
+		{
+			int decided_start = decided_cnt;
+			int onlist_start = onlist_cnt;
+			
+			if (place_catalyst (tp, c, x - c->on_x [k], y - c->on_y [k]))
+			{
+				if (added_on_budget != PARM_DISABLED && onlist_cnt > added_on_budget)
+				{
+					prune_too_many_added_static_on++;
+					budget_cuts++;
+				}
+				else
+				{
+					compl_result cr = test_compl ();
+					if (cr == COMPL_OK)
+					{
+						uint64_t key = transposition_key (allow_new_oncells, first_next_sol_gen);
+						uint64_t budget_cuts_before = budget_cuts;
+						
+						decided_latest = decided_start;
+						if (is_transposition (key))
+							prune_transposition++;
+						else if (matches_nogood ())
+							prune_nogood++;
+						else
+						{
+							static_serial++;
+							
+							gp->flags |= CHANGED;
+							
+							recurse_subtree (u, gp, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+							if (!deferring)
+								add_transposition (key, budget_cuts_before);
+						}
+					}
+					else if (cr == COMPL_FAILED_LOCAL_RECT)
+						prune_too_compl_local_rect++;
+					else if (cr == COMPL_FAILED_OVERALL_LOCALLY)
+						prune_too_compl_overall_locally++;
+					else if (cr == COMPL_FAILED_TOO_MANY_RECTS)
+						prune_too_many_local_rects++;
+					else if (cr == COMPL_FAILED_GLOBALLY)
+						prune_too_compl_globally++;
+				}
+			}
+			
+			onlist_cnt = onlist_start;
+			if (decided_cnt > decided_start)
+			{
+				unplace_cells (decided_start);
+				static_serial++;
+				
+				gp->flags |= CHANGED;
+			}
+			
+			if (deferring)
+				return;
+		}
+	}
+}
+
+// Recurse after a cell decision, unless the decided cells match a nogood, or an earlier
+// iterative deepening pass already searched the same subtree without hitting its budget
+static void recurse_decided (universe *u, generation *gp, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen)
+{
+	uint64_t key = 0, budget_cuts_before = budget_cuts;
+	
+	if (oncell_deepening)
+	{
+		key = transposition_key (allow_new_oncells, first_next_sol_gen);
+		if (is_transposition (key))
+		{
+			prune_transposition++;
+			return;
+		}
+	}
+	
+	if (matches_nogood ())
+	{
+		prune_nogood++;
+		return;
+	}
+	
+	recurse_subtree (u, gp, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+	
+	if (oncell_deepening && !deferring)
+		add_transposition (key, budget_cuts_before);
+}
+
+static void bellman_choose_cells (universe *u, generation *g, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen)
+{
+	// Look for a tile with some unknown cells.
+	// bellman_recurse has just evolved everything up to the first generation with unknown cells,
+	// and every generation knows its first tile with unknown cells, so start right there.
+	
+	int ntiles = u_evolving->ntiles;
+	generation *g_end = u_evolving->gens + u_evolving->n_gens;
+	
+	for(g = u_evolving->gens + first_gen_with_unknown_cells; g < g_end && g->first_unknown_tile < 0; g++)
+		;
+	
+	if(g == g_end)
+	{
+		// We got all the way to the end of the pattern. This should not happen anymore - all
+		// solutions should be found before here and anything else should already be pruned
+		// Remember and report when search completed
+		
+		got_to_end_of_pattern = YES;
+		return;
+	}
+	
+	// Find an unknown successor cell that's in the neighbourhood
+	// of an unknown-stable predecessor cell.
+	
+	assert_if_debug(g != u_evolving->gens);
+	
+	tile *t = g->tiles + g->first_unknown_tile;
+	assert_if_debug(t->flags & HAS_UNKNOWN_CELLS);
+	
+	// The same tile in the previous generation
+	tile *tp = t - ntiles;
+	generation *gp = g - 1;
+	
+	int x, y, dx, dy;
+	
+	if (!choose_cell (t, tp, g->gen, &x, &y, &dx, &dy))
+	{
+		fprintf(stderr, "Didn't find an unknown cell!\n");
+		assert(0);
+		return;
+	}
+	
+#ifdef CHECK_CHOOSE_CELL
+	int sx = -1, sy = -1, sdx = 2, sdy = 2;
+	if (!choose_cell_by_scan (t, tp, g->gen, &sx, &sy, &sdx, &sdy) || sx != x || sy != y || sdx != dx || sdy != dy)
+	{
+		fprintf (stderr, "choose_cell picked (%d, %d)+(%d, %d), legacy scan picked (%d, %d)+(%d, %d)\n", x, y, dx, dy, sx, sy, sdx, sdy);
+		exit (-1);
+	}
+#endif
+	
+	assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
+	assert_if_debug(tile_get_cell(tp, x+dx, y+dy) == UNKNOWN_STABLE);
+	assert_if_debug(tile_get_cell((tile *)t->auxdata, x+dx, y+dy) == UNKNOWN_STABLE);
+	
+	assert_if_debug(dx <= 1);
+	assert_if_debug(dy <= 1);
+	x += dx;
+	y += dy;
+	
+	int xmirror[8], ymirror[8], n_sym, i;
+	int decided_start = decided_cnt;
+	
+	n_sym = xy_symmetry(x, y, xmirror, ymirror);
+	
+	for(i = 0; i < n_sym; i++) {
+		if(tile_get_cell(tp, xmirror[i], ymirror[i]) != UNKNOWN_STABLE) {
+			fprintf(stderr, "Input region is asymmetric (%d,%d)=%d (%d,%d)=%d\n",
+					x, y, tile_get_cell(tp, x, y),
+					xmirror [i], ymirror [i], tile_get_cell(tp, xmirror [i], ymirror [i]));
+			exit(-1);
+		}
+	}
+	
+	
+	// Recurse with the selected cell as ON, or as part of a catalyst from the library
+	if (allow_new_oncells)
+	{
+		if (n_catalysts > 0)
+			place_catalysts (u, gp, tp, x, y, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+		else if (added_on_budget == PARM_DISABLED || onlist_cnt + n_sym <= added_on_budget)
+		{
+			if (onlist_cnt + n_sym > MAX_MAX_ADDED_STATIC_ON)
+			{
+				fprintf (stderr, "On-cell list overflow\n");
+				assert (0);
+			}
+			
+			for(i = 0; i < n_sym; i++)
+			{
+				onlist_x [onlist_cnt] = xmirror [i];
+				onlist_y [onlist_cnt] = ymirror [i];
+				onlist_cnt++;
+			}
+			
+			compl_result cr = test_compl ();
+			if (cr == COMPL_OK)
+			{
+				decided_latest = decided_start;
+				for(i = 0; i < n_sym; i++){
+					tile_set_cell(tp,  xmirror[i], ymirror[i], ON);
+					tile_set_cell((tile *)t->auxdata,  xmirror[i], ymirror[i], ON);
+					add_decided_cell(tp, xmirror[i], ymirror[i], ON);
+				}
+				static_serial++;
+				
+				gp->flags |= CHANGED;
+				
+				recurse_decided (u, gp, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+				drop_decided_cells (decided_start);
+			}
+			else if (cr == COMPL_FAILED_LOCAL_RECT)
+				prune_too_compl_local_rect++;
+			else if (cr == COMPL_FAILED_OVERALL_LOCALLY)
+				prune_too_compl_overall_locally++;
+			else if (cr == COMPL_FAILED_TOO_MANY_RECTS)
+				prune_too_many_local_rects++;
+			else if (cr == COMPL_FAILED_GLOBALLY)
+				prune_too_compl_globally++;
+			
+			onlist_cnt -= n_sym;
+			
+		}
+		else
+		{
+			prune_too_many_added_static_on++;
+			budget_cuts++;
+		}
+	}
+	else
+		prune_stopped_adding_oncells++;
+	
+	
+	// Recurse with the selected cell as OFF, unless the subtree is being deferred
+	if (!deferring)
+	{
+		decided_latest = decided_start;
+		for(i = 0; i < n_sym; i++){
+			tile_set_cell(tp,  xmirror[i], ymirror[i], OFF);
+			tile_set_cell((tile *)t->auxdata,  xmirror[i], ymirror[i], OFF);
+			add_decided_cell(tp, xmirror[i], ymirror[i], OFF);
+		}
+		static_serial++;
+		
+		gp->flags |= CHANGED;
+		
+		recurse_decided (u, gp, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+		drop_decided_cells (decided_start);
+	}
+	
+	for(i = 0; i < n_sym; i++){
+		tile_set_cell(tp,  xmirror[i], ymirror[i], UNKNOWN_STABLE);
+		tile_set_cell((tile *)t->auxdata,  xmirror[i], ymirror[i], UNKNOWN_STABLE);
+	}
+	static_serial++;
+	
+	gp->flags |= CHANGED;
+}
 
-	case VERT:
-		if(x >= symmetry_ofs - x)
-			return YES;
-		else
-			return NO;
+// Mark the cell at (x, y), and its 8 neighbours if wide, in generation 0 of u
+static void mark_cell (universe *u, int x, int y, int wide)
+{
+	int dx, dy, r = wide ? 1 : 0;
+	
+	for (dy = -r; dy <= r; dy++)
+		for (dx = -r; dx <= r; dx++)
+			tile_set_cell (generation_find_tile (u->first, x + dx, y + dy, YES), x + dx, y + dy, ON);
+}
 
-	default:
-		return NO;
+// A static cell that is still unknown only gets chosen by bellman_choose_cells when an unknown
+// cell appears next to it in the evolving universe. Fixing static cells can only make fewer
+// evolving cells unknown, so the evolution that has just been done with all of them unknown
+// shows every static cell the search can ever choose before the last generation.
+// Unknown static cells that are not next to one of those, or to a static ON cell, are turned OFF.
+// The stability check for the cells that can be chosen never looks that far, so no solutions are lost.
+static void remove_unreachable_unknowns ()
+{
+	universe *u_unknown = universe_new (OFF);	// evolving cells that are ever unknown
+	universe *u_keep = universe_new (OFF);		// static cells that stay unknown
+	generation *g;
+	tile *t, *ts;
+	int x, y, i;
+	int n_unknown = 0, n_removed = 0;
+	
+	for (g = u_evolving->gens; g < u_evolving->gens + u_evolving->n_gens; g++)
+		for (t = g->tiles + u_evolving->used_lo; t < g->tiles + u_evolving->used_hi; t++)
+		{
+			if (!t->unknown_rows)
+				continue;
+			
+			tile *tu = generation_find_tile (u_unknown->first, t->xpos, t->ypos, YES);
+			for (y = 0; y < TILE_HEIGHT; y++)
+				tu->bit0 [y] |= t->bit1 [y] & ~t->bit0 [y];
+		}
+	
+	for (ts = u_static->first->all_first; ts; ts = ts->all_next)
+		for (y = 0; y < TILE_HEIGHT; y++)
+			for (x = 0; x < TILE_WIDTH; x++)
+			{
+				cellvalue v = tile_get_cell (ts, x, y);
+				
+				if (v == ON)
+					mark_cell (u_keep, ts->xpos + x, ts->ypos + y, YES);
+				else if (v == UNKNOWN_STABLE)
+				{
+					int dx, dy, reachable = NO;
+					
+					for (dy = -1; dy <= 1 && !reachable; dy++)
+						for (dx = -1; dx <= 1 && !reachable; dx++)
+							reachable = is_on_cell (u_unknown->first, ts->xpos + x + dx, ts->ypos + y + dy);
+					
+					if (!reachable)
+						continue;
+					
+					// Choosing a cell also chooses its mirror images
+					int xmirror[8], ymirror[8];
+					int n_sym = xy_symmetry (x, y, xmirror, ymirror);
+					
+					for (i = 0; i < n_sym; i++)
+						mark_cell (u_keep, ts->xpos + xmirror [i], ts->ypos + ymirror [i], YES);
+				}
+			}
+	
+	for (ts = u_static->first->all_first; ts; ts = ts->all_next)
+		for (y = 0; y < TILE_HEIGHT; y++)
+			for (x = 0; x < TILE_WIDTH; x++)
+				if (tile_get_cell (ts, x, y) == UNKNOWN_STABLE)
+				{
+					n_unknown++;
+					
+					if (is_on_cell (u_keep->first, ts->xpos + x, ts->ypos + y))
+						continue;
+					
+					tile_set_cell (ts, x, y, OFF);
+					tile_set_cell (generation_find_tile (u_evolving->first, ts->xpos + x, ts->ypos + y, NO), x, y, OFF);
+					n_removed++;
+				}
+	
+	universe_free (u_unknown);
+	universe_free (u_keep);
+	
+	printf ("--- Removed %d of %d unknown static cells that can't be reached before generation %d\n", n_removed, n_unknown, max_gens);
+	
+	if (n_removed > 0)
+	{
+		static_serial++;
+		bellman_evolve_generations (u_evolving->first, max_gens);
 	}
 }
 
-static int xy_symmetry(int x, int y, int* mirrorx_arr, int* mirrory_arr)
+// Search from the start. With iterative deepening, this is done in passes that allow
+// 1, 2, 3, ... added static on-cells, so the small solutions are found first. The passes
+// end when one of them never hit its budget, or at max_added_static_on.
+// Returns NO if the search was interrupted because max_results was reached
+static int bellman_search ()
 {
-	mirrorx_arr[0] = x;
-	mirrory_arr[0] = y;
+	clear_transpositions ();
+	reported_budget = -1;
 	
-	switch(symmetry_type) {
-		case NONE:
-			return 1;
-		case HORIZ:
-			if(y == symmetry_ofs - y)
-				return 1;
-			
-			mirrorx_arr[1] = x;
-			mirrory_arr[1] = symmetry_ofs - y;
-			
-			return 2;
-			
-		case VERT:
-			if(x == symmetry_ofs - x)
-				return 1;
-			
-			mirrorx_arr[1] =  symmetry_ofs - x;
-			mirrory_arr[1] = y;
-			
-			return 2;
+	if (!oncell_deepening || max_added_static_on == 0)
+	{
+		added_on_budget = max_added_static_on;
+		return bellman_recurse (u_evolving, u_evolving->first, YES, 0, 0);
+	}
+	
+	for (added_on_budget = 1; ; added_on_budget++)
+	{
+		uint64_t budget_cuts_before = budget_cuts;
+		
+		printf ("--- Starting pass with at most %d added static on-cells\n", added_on_budget);
+		if (!bellman_recurse (u_evolving, u_evolving->first, YES, 0, 0))
+			return NO;
+		if (max_results != PARM_DISABLED && solcount >= max_results)
+			return NO;
+		
+		if (budget_cuts == budget_cuts_before || added_on_budget == max_added_static_on || added_on_budget == MAX_MAX_ADDED_STATIC_ON)
+			return YES;
+		
+		reported_budget = added_on_budget;
+	}
+}
+
+// Find the tile of generation 0 that holds the cell at (x, y)
+static tile *find_first_gen_tile (int x, int y)
+{
+	tile *t;
+	for (t = u_evolving->gens->tiles; t < u_evolving->gens->tiles + u_evolving->ntiles; t++)
+		if (x >= t->xpos && x < t->xpos + TILE_WIDTH && y >= t->ypos && y < t->ypos + TILE_HEIGHT)
+			return t->auxdata ? t : NULL;
+	
+	return NULL;
+}
+
+// Search a deferred subtree to the end, from the start with its decided cells set.
+// Returns NO if the search was interrupted because max_results was reached
+static int revisit_subtree (const deferred_subtree *d)
+{
+	generation *g0 = u_evolving->gens;
+	int i, result;
+	
+	for (i = 0; i < d->n_cells; i++)
+	{
+		int x = d->cells [3 * i], y = d->cells [3 * i + 1];
+		cellvalue v = d->cells [3 * i + 2];
+		tile *t = find_first_gen_tile (x, y);
+		
+		if (!t || tile_get_cell ((tile *) t->auxdata, x - t->xpos, y - t->ypos) != UNKNOWN_STABLE || (v != ON && v != OFF))
+		{
+			fprintf (stderr, "Deferred subtree doesn't fit the pattern at (%d, %d)\n", x, y);
+			exit (-1);
+		}
+		
+		if (v == ON)
+		{
+			if (onlist_cnt >= MAX_MAX_ADDED_STATIC_ON)
+			{
+				fprintf (stderr, "On-cell list overflow\n");
+				assert (0);
+			}
 			
-		default:
-			return 1;
+			onlist_x [onlist_cnt] = x;
+			onlist_y [onlist_cnt] = y;
+			onlist_cnt++;
+		}
+		
+		tile_set_cell (t, x - t->xpos, y - t->ypos, v);
+		tile_set_cell ((tile *) t->auxdata, x - t->xpos, y - t->ypos, v);
+		add_decided_cell (t, x - t->xpos, y - t->ypos, v);
+	}
+	static_serial++;
+	
+	g0->flags |= CHANGED;
+	
+	clear_transpositions ();
+	current_single_gen = d->single_gen;
+	added_on_budget = max_added_static_on;
+	reported_budget = d->reported_budget;
+	revisited = d;
+	
+	result = bellman_recurse (u_evolving, g0, YES, 0, d->first_next_sol_gen);
+	
+	revisited = NULL;
+	
+	for (i = 0; i < decided_cnt; i++)
+	{
+		tile_set_cell (decided_tile [i], decided_x [i], decided_y [i], UNKNOWN_STABLE);
+		tile_set_cell ((tile *) decided_tile [i]->auxdata, decided_x [i], decided_y [i], UNKNOWN_STABLE);
+	}
+	drop_decided_cells (0);
+	onlist_cnt = 0;
+	static_serial++;
+	
+	g0->flags |= CHANGED;
+	
+	return result;
+}
+
+// Returns NO if the search was interrupted because max_results was reached
+static int revisit_deferred_subtrees ()
+{
+	const deferred_subtree *d;
+	int i = 0;
+	
+	for (d = deferred_first; d; d = d->next)
+	{
+		printf ("\n--- Revisiting deferred subtree %d of %d\n", ++i, deferred_cnt);
+		if (!revisit_subtree (d))
+			return NO;
 	}
+	
+	return YES;
 }
 
+#ifndef _WIN32
 
-static int distance_sq (int x1, int y1, int x2, int y2)
+// Parallel strictly-gen-by-gen search.
+// The generations are independent searches, so each one is searched by a forked worker process,
+// which starts from the parsed and evolved pattern of the main process. Workers write their
+// results to temporary files, and the main process renames them in generation order once all
+// earlier generations are done, so the results are numbered just like in a sequential search.
+// For the same reason, a worker only writes the subtrees it deferred to a file. The main process
+// queues them in generation order, and searches them after all generations, as in a sequential search.
+
+typedef struct {
+	int solcount;
+	int got_to_end_of_pattern;
+	int deferred_cnt;
+	uint32_t nogood_cnt;
+	uint64_t counters [N_WORKER_COUNTERS];
+} worker_report;
+
+static void run_worker (int sg, int fd)
 {
-	return (x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1);
+	int i;
+	
+	// Start from zero, as the main process has added the reports of earlier workers
+	solcount = 0;
+	got_to_end_of_pattern = NO;
+	nogood_cnt = 0;
+	for (i = 0; i < N_WORKER_COUNTERS; i++)
+		*worker_counters [i] = 0;
+	
+	worker_gen = sg;
+	current_single_gen = sg;
+	worker_deferred_file_name (deferred_file_name, sizeof deferred_file_name, sg);
+	
+	// The main process may already have opened the results stream, but that one is its own
+	close_results_stream ();
+	
+	// Likewise for the subtrees that earlier workers deferred
+	if (deferred_file)
+	{
+		fclose (deferred_file);
+		deferred_file = NULL;
+	}
+	deferred_first = deferred_last = NULL;
+	memset (deferred_hash, 0, sizeof deferred_hash);
+	deferred_cnt = 0;
+	
+	static char stream_name [40];
+	if (results_stream_name)
+	{
+		worker_stream_name (stream_name, sizeof stream_name, sg);
+		results_stream_name = stream_name;
+	}
+	setvbuf (stdout, NULL, _IOFBF, BUFSIZ);
+	
+	status_timer_started = NO;
+	start_status_timer ();
+	
+	last_new_gen_time = time (NULL);
+	printf ("\n--- Starting generation %d\n", sg);
+	
+	bellman_search ();
+	
+	print_prune_counters (YES);
+	close_results_stream ();
+	
+#ifdef PROFILE_SEARCH
+	char profile_name [40];
+	snprintf (profile_name, sizeof profile_name, "gen%03d-profile.txt", sg);
+	write_profile (profile_name);
+#endif
+	
+	worker_report r;
+	
+	memset (&r, 0, sizeof r);
+	r.solcount = solcount;
+	r.got_to_end_of_pattern = got_to_end_of_pattern;
+	r.deferred_cnt = deferred_cnt;
+	r.nogood_cnt = nogood_cnt;
+	for (i = 0; i < N_WORKER_COUNTERS; i++)
+		r.counters [i] = *worker_counters [i];
+	
+	if (write (fd, &r, sizeof r) != (ssize_t) sizeof r)
+	{
+		perror ("write");
+		exit (-1);
+	}
+	
+	exit (0);
 }
 
-typedef enum {COMPL_OK, COMPL_FAILED_LOCAL_RECT, COMPL_FAILED_OVERALL_LOCALLY, COMPL_FAILED_TOO_MANY_RECTS, COMPL_FAILED_GLOBALLY} compl_result;
+static int read_worker_report (int fd, worker_report *r)
+{
+	size_t done = 0;
+	
+	while (done < sizeof *r)
+	{
+		ssize_t n = read (fd, (char *) r + done, sizeof *r - done);
+		if (n <= 0)
+			return NO;
+		done += n;
+	}
+	
+	return YES;
+}
 
-typedef struct
+// Append the results of a finished generation to the results stream
+static void append_worker_stream (int sg)
 {
-	int xon;
-	int xoff;
-	int yon;
-	int yoff;
-	int oncnt;
-	int free_cells;
-	int compl_limit;
-} compl_box;
+	char name [40];
+	worker_stream_name (name, sizeof name, sg);
+	char *idx_name = index_file_name (name);
+	
+	FILE *f = fopen (name, "rb");
+	FILE *fi = fopen (idx_name, "rb");
+	if (!f || !fi)
+	{
+		perror (f ? idx_name : name);
+		exit (-1);
+	}
+	
+	result_index_entry e;
+	char *buf = NULL;
+	uint32_t buf_size = 0;
+	
+	while ((max_results == PARM_DISABLED || solcount < max_results) && fread (&e, sizeof e, 1, fi) == 1)
+	{
+		if (e.length > buf_size)
+		{
+			buf_size = e.length;
+			buf = realloc (buf, buf_size);
+			if (!buf)
+			{
+				fprintf (stderr, "Out of memory\n");
+				exit (-1);
+			}
+		}
+		
+		if (fseek64 (f, e.offset, SEEK_SET) != 0 || fread (buf, 1, e.length, f) != e.length)
+		{
+			fprintf (stderr, "Can't read result %u from %s\n", e.id, name);
+			exit (-1);
+		}
+		
+		if (!results_stream)
+			open_results_stream ();
+		
+		uint64_t offset = ftell64 (results_stream);
+		fwrite (buf, 1, e.length, results_stream);
+		solcount++;
+		add_stream_index_entry (solcount, offset, offset + e.length, e.accept_gen, e.max_active, e.glider_count);
+		last_sol_time = time (NULL);
+	}
+	
+	free (buf);
+	fclose (f);
+	fclose (fi);
+	remove (name);
+	remove (idx_name);
+	free (idx_name);
+}
 
-static void compl_box_init (compl_box *cb, int free_cells, int compl_limit)
+// Queue the subtrees that the worker of a finished generation deferred, behind those of the
+// earlier generations, and add them to the deferred file of the main process
+static void queue_worker_deferred (int sg)
 {
-	cb->xon = 0;
-	cb->xoff = 0;
-	cb->yon = 0;
-	cb->yoff = 0;
-	cb->oncnt = 0;
-	cb->free_cells = free_cells;
-	cb->compl_limit = compl_limit;
+	char name [40];
+	worker_deferred_file_name (name, sizeof name, sg);
+	
+	deferred_subtree *last = deferred_last;
+	load_deferred_subtrees (name);
+	remove (name);
+	
+	const deferred_subtree *d;
+	for (d = last ? last->next : deferred_first; d; d = d->next)
+		write_deferred_subtree (d);
 }
 
-static void compl_box_copy (const compl_box *src, compl_box *dst)
+// Give the results of a finished generation their final numbers
+static void number_worker_results (int sg, int n_sols)
 {
-	dst->xon = src->xon;
-	dst->xoff = src->xoff;
-	dst->yon = src->yon;
-	dst->yoff = src->yoff;
-	dst->oncnt = src->oncnt;
-	dst->free_cells = src->free_cells;
-	dst->compl_limit = src->compl_limit;
+	char tmp_name [40], name [40];
+	int i;
+	
+	if (results_stream_name)
+	{
+		if (n_sols > 0)
+			append_worker_stream (sg);
+		return;
+	}
+	
+	for (i = 1; i <= n_sols; i++)
+	{
+		worker_result_file_name (tmp_name, sizeof tmp_name, sg, i);
+		
+		if (max_results != PARM_DISABLED && solcount >= max_results)
+			remove (tmp_name);
+		else
+		{
+			result_file_name (name, sizeof name, ++solcount);
+			if (rename (tmp_name, name) != 0)
+				perror (tmp_name);
+			last_sol_time = time (NULL);
+		}
+	}
 }
 
-static void compl_box_add_cell (compl_box *cb, int x, int y)
+static void search_gens_in_parallel (int n_workers)
 {
-	if (cb->oncnt == 0)
+	int n_gens = max_first_act_gen - min_first_act_gen + 1;
+	pid_t *pids = calloc (n_gens, sizeof *pids);
+	int *fds = calloc (n_gens, sizeof *fds);
+	int *n_sols = calloc (n_gens, sizeof *n_sols);
+	int *n_deferred = calloc (n_gens, sizeof *n_deferred);
+	int n_started = 0, n_running = 0, n_numbered = 0, stopped = NO;
+	int i, k;
+	
+	if (!pids || !fds || !n_sols || !n_deferred)
 	{
-		cb->xon = x;
-		cb->xoff = x + 1;
-		cb->yon = y;
-		cb->yoff = y + 1;
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
+	}
+	
+	for (i = 0; i < n_gens; i++)
+		n_sols [i] = -1;
+	
+	printf ("--- Searching generations %d to %d in %d worker processes\n", min_first_act_gen, max_first_act_gen, n_workers);
+	
+	for (;;)
+	{
+		while (!stopped && n_running < n_workers && n_started < n_gens)
+		{
+			int pipe_fds [2];
+			
+			if (pipe (pipe_fds) != 0)
+			{
+				perror ("pipe");
+				exit (-1);
+			}
+			
+			fflush (stdout);
+			fflush (stderr);
+			if (results_stream)
+			{
+				fflush (results_stream);
+				fflush (results_index);
+			}
+			
+			pid_t pid = fork ();
+			if (pid < 0)
+			{
+				perror ("fork");
+				exit (-1);
+			}
+			
+			if (pid == 0)
+			{
+				close (pipe_fds [0]);
+				run_worker (min_first_act_gen + n_started, pipe_fds [1]);
+			}
+			
+			close (pipe_fds [1]);
+			pids [n_started] = pid;
+			fds [n_started] = pipe_fds [0];
+			n_started++;
+			n_running++;
+		}
+		
+		if (n_running == 0)
+			break;
+		
+		int status;
+		pid_t pid = wait (&status);
+		if (pid < 0)
+		{
+			perror ("wait");
+			exit (-1);
+		}
+		
+		for (i = 0; i < n_started && pids [i] != pid; i++)
+			;
+		if (i == n_started)
+			continue;
+		
+		n_running--;
+		pids [i] = 0;
+		
+		worker_report r;
+		int got_report = read_worker_report (fds [i], &r);
+		close (fds [i]);
+		
+		if (stopped)
+			continue;
+		
+		if (!got_report)
+		{
+			fprintf (stderr, "The worker for generation %d failed\n", min_first_act_gen + i);
+			exit (-1);
+		}
+		
+		n_sols [i] = r.solcount;
+		n_deferred [i] = r.deferred_cnt;
+		got_to_end_of_pattern |= r.got_to_end_of_pattern;
+		nogood_cnt += r.nogood_cnt;
+		for (k = 0; k < N_WORKER_COUNTERS; k++)
+			*worker_counters [k] += r.counters [k];
+		
+		printf ("--- Generation %d done, %d solutions\n", min_first_act_gen + i, r.solcount);
+		
+		// Number the results of the generations that now have all earlier ones done
+		while (n_numbered < n_started && n_sols [n_numbered] >= 0)
+		{
+			number_worker_results (min_first_act_gen + n_numbered, n_sols [n_numbered]);
+			if (n_deferred [n_numbered] > 0)
+				queue_worker_deferred (min_first_act_gen + n_numbered);
+			n_numbered++;
+			
+			// All running workers search later generations, so their results aren't needed
+			if (max_results != PARM_DISABLED && solcount >= max_results && !stopped)
+			{
+				stopped = YES;
+				for (k = 0; k < n_started; k++)
+					if (pids [k])
+						kill (pids [k], SIGTERM);
+			}
+		}
 	}
-	else
+	
+	// Remove what the stopped workers wrote
+	for (i = n_numbered; i < n_started; i++)
 	{
-		cb->xon = lowest_of (cb->xon, x);
-		cb->xoff = highest_of (cb->xoff, x + 1);
-		cb->yon = lowest_of (cb->yon, y);
-		cb->yoff = highest_of (cb->yoff, y + 1);
+		char tmp_name [40];
+		
+		worker_stream_name (tmp_name, sizeof tmp_name, min_first_act_gen + i);
+		char *idx_name = index_file_name (tmp_name);
+		remove (tmp_name);
+		remove (idx_name);
+		free (idx_name);
+		
+		worker_deferred_file_name (tmp_name, sizeof tmp_name, min_first_act_gen + i);
+		remove (tmp_name);
+		
+		for (k = 1; ; k++)
+		{
+			worker_result_file_name (tmp_name, sizeof tmp_name, min_first_act_gen + i, k);
+			if (remove (tmp_name) != 0)
+				break;
+		}
 	}
 	
-	cb->oncnt++;
+	free (pids);
+	free (fds);
+	free (n_sols);
+	free (n_deferred);
 }
 
-static void compl_box_merge (const compl_box *src, compl_box *dst)
-{
-	dst->xon = lowest_of (dst->xon, src->xon);
-	dst->xoff = highest_of (dst->xoff, src->xoff);
-	dst->yon = lowest_of (dst->yon, src->yon);
-	dst->yoff = highest_of (dst->yoff, src->yoff);
-	dst->oncnt += src->oncnt;
-}
+#endif
 
-static int compl_box_size_compl (const compl_box *cb)
+// Checks the parameters of the input and works out how many generations to evolve
+static void set_max_gens ()
 {
-	int longside = highest_of (cb->xoff - cb->xon, cb->yoff - cb->yon);
-	int shortside = lowest_of (cb->xoff - cb->xon, cb->yoff - cb->yon);
+	if (!verify_and_fix_parameters ())
+		exit (-1);
 	
-	return 2 * longside + shortside;
-}
+	if (accept1_inact_gens == PARM_DISABLED)
+		max_gens = max_last_act_gen + (accept2_act_inact_gens - 1) + 1;
+	else if (accept2_act_inact_gens == PARM_DISABLED)
+		max_gens = max_last_act_gen + accept1_inact_gens + 1;
+	else
+		max_gens = lowest_of (max_last_act_gen + (accept2_act_inact_gens - 1) + 1, max_last_act_gen + accept1_inact_gens + 1);
 
-static int compl_box_within_limit (const compl_box *cb)
-{
-	return (compl_box_size_compl (cb) + highest_of (0, cb->oncnt - cb->free_cells)) <= cb->compl_limit;
+	max_gens = highest_of (max_gens, u_filter->n_gens + 1);
 }
 
-
-static int box_cnt;
-static compl_box temp_box [MAX_MAX_UNMERGED_LOCAL_RECTS];
-static int box_of_cell [MAX_MAX_ADDED_STATIC_ON];
-
-static void delete_compl_box (int del_ix, int new_cell_box)
+// Links up the universes of the input pattern and evolves it for max_gens generations
+static void prepare_universes ()
 {
-	int cell_ix;
-	for (cell_ix = 0; cell_ix < onlist_cnt; cell_ix++)
-	{
-		if (box_of_cell [cell_ix] == del_ix)
-			box_of_cell [cell_ix] = new_cell_box;
-		if (box_of_cell [cell_ix] > del_ix)
-			box_of_cell [cell_ix]--;
+	generation *g;
+	tile *t;
+	int i;
+	
+	universe_evolve_next(u_static);
+	
+	g = universe_find_generation(u_static, 0, 0);
+	for(t = g->all_first; t; t = t->all_next) {
+		tile *t2 = universe_find_tile(u_forbidden, 0, t->xpos, t->ypos, 0);
+		if(t2) t->auxdata = t2;
 	}
 	
-	int box_ix;
-	for (box_ix = del_ix; box_ix < box_cnt - 1; box_ix++)
-		compl_box_copy (&temp_box [box_ix + 1], &temp_box [box_ix]);
+	for(i=0; i<max_gens; i++)
+		universe_evolve_next(u_evolving);
 	
-	box_cnt--;
+	make_evolving_contiguous ();
+	
+	for(g = u_evolving->gens; g < u_evolving->gens + u_evolving->n_gens; g++) {
+		for(t = g->tiles; t < g->tiles + u_evolving->ntiles; t++) {
+			tile *t2 = universe_find_tile(u_static, 0, t->xpos, t->ypos, 0);
+			if(t2) t->auxdata = t2;
+			
+			/* no filter in the final generation: */
+			t->filter = NULL;
+			if((int) g->gen < max_gens) {
+				t2 = universe_find_tile(u_filter, g->gen + 1, t->xpos, t->ypos, 0);
+				if(t2) t->filter = t2;
+			}
+		}
+	}
+	
+	bellman_evolve_generations(u_evolving->first, max_gens);
 }
 
-static compl_result test_compl_locally ()
+// Classify mode (-c).
+// Prints the history of each input and a hash of the spark it leaves behind, so that results
+// which do the same thing can be found. The inputs are result files, or results streams from
+// -o or -b, which are known by the index file next to them. All inputs are classified with the
+// parameters of the first one, which the results of one search have in common.
+
+// A hash of the cells where a tile differs from the same tile of the static pattern. Only the set
+// bits of each word of differences are visited, but they add to the hash cell by cell as before,
+// so the hashes are the same as those of earlier versions.
+static uint32_t spark_tile_hash (const tile *t, const tile *stable)
 {
-	int max_compl = (max_local_rect_compl == PARM_DISABLED) ? max_overall_local_compl : max_local_rect_compl;
-	int free_cells = (max_local_rect_compl == PARM_DISABLED) ? LOCAL_COMPL_OVERALL_FREE_CELLS : LOCAL_RECT_FREE_CELLS;
-	int fail_code = (max_local_rect_compl == PARM_DISABLED) ? COMPL_FAILED_OVERALL_LOCALLY : COMPL_FAILED_LOCAL_RECT;
-	
-	box_cnt = 0;
+	uint32_t hash = 1;
+	int y;
 	
-	int obj_ix;
-	for (obj_ix = 0; obj_ix < onlist_cnt; obj_ix++)
+	for (y = 0; y < TILE_HEIGHT; y++)
 	{
-		box_of_cell [obj_ix] = -1;
+		TILE_WORD stable_bit0 = stable ? stable->bit0 [y] : 0;
+		TILE_WORD stable_bit1 = stable ? stable->bit1 [y] : 0;
+		TILE_WORD diff = (t->bit0 [y] ^ stable_bit0) | (t->bit1 [y] ^ stable_bit1);
 		
-		int ref_ix;
-		for (ref_ix = 0; ref_ix < obj_ix; ref_ix++)
+		while (diff)
 		{
-			int dist_sq = distance_sq (onlist_x [obj_ix], onlist_y [obj_ix], onlist_x [ref_ix], onlist_y [ref_ix]);
+			int x = __builtin_ctzll ((uint64_t) diff);
+			uint32_t t1 = ((t->bit0 [y] >> x) & 1) | (((t->bit1 [y] >> x) & 1) << 1);
+			uint32_t t2 = ((stable_bit0 >> x) & 1) | (((stable_bit1 >> x) & 1) << 1);
 			
-			if (dist_sq < min_rect_separation_sq)
-			{
-				if (box_of_cell [obj_ix] == -1)
-				{
-					// obj_ix cell was not yet in a box, but it is close to a cell in an existing box, so add it to that box
-					compl_box_add_cell (&temp_box [box_of_cell [ref_ix]], onlist_x [obj_ix], onlist_y [obj_ix]);
-					if (!compl_box_within_limit (&temp_box [box_of_cell [ref_ix]]))
-						return fail_code;
-					
-					box_of_cell [obj_ix] = box_of_cell [ref_ix];
-				}
-				else if (box_of_cell [obj_ix] != box_of_cell [ref_ix])
-				{
-					// obj_ix cell was already in a box, but it is also close to a cell in another box, so these boxes must be merged
-					
-					compl_box_merge (&temp_box [box_of_cell [obj_ix]], &temp_box [box_of_cell [ref_ix]]);
-					if (!compl_box_within_limit (&temp_box [box_of_cell [ref_ix]]))
-						return fail_code;
-					
-					delete_compl_box (box_of_cell [obj_ix], box_of_cell [ref_ix]);
-				}
-			}
+			hash = (hash ^ t1) * 0xabcdef13;
+			hash = (hash ^ t2) * 0xabcdef13;
+			hash = (hash ^ x) * 0xabcdef13;
+			hash = (hash ^ y) * 0xabcdef13;
+			
+			diff &= diff - 1;
+		}
+	}
+	
+	return hash;
+}
+
+static uint32_t classify_pattern (int verbose)
+{
+	generation *g, *g_last;
+	tile *t;
+	int ac_first, ac_last;
+	uint32_t klass;
+	
+	if(verbose > 0) {
+		if(verbose > 1)
+			dump(YES);
+		for(g = u_evolving->first; g; g = g->next) {
+			printf("Generation %d: %x: %s\n", g->gen, g->flags, flag2str(g->flags));
 		}
 		
-		if (box_of_cell [obj_ix] == -1)
-		{
-			// obj_ix cell was not close to a cell in an existing box, so start a new box and put it there
-			if (box_cnt >= MAX_MAX_UNMERGED_LOCAL_RECTS)
-			{
-				fprintf (stderr, "Unmerged local rectangles buffer overflow\n");
-				exit (-1);
+	}
+	
+	// print the history
+	int in_interaction = 0, interaction_nr = 0;
+	
+	for(g = u_evolving->first->next; g; g = g->next) {
+		if(!(g->flags & IS_LIVE)) {
+			printf("log: g%d: died out\n", g->gen);
+			break;
+		}
+		if(g->flags & HAS_UNKNOWN_CELLS) {
+			printf("log: g%d: became undetermined\n", g->gen);
+			break;
+		}
+		if(!(g->flags & DIFFERS_FROM_PREVIOUS)) {
+			printf("log: g%d: became stable\n", g->gen);
+			break;
+		}
+		if(!(g->flags & DIFFERS_FROM_2PREV)) {
+			printf("log: g%d: became period 2\n", g->gen);
+			break;
+		}
+		
+		if(!in_interaction) {
+			if(g->flags & DIFFERS_FROM_STABLE) {
+				interaction_nr++;
+				in_interaction = 1;
+				printf("log: g%d: interaction %d begins\n",
+					   g->gen, interaction_nr);
+			}
+		} else {
+			if(!(g->flags & DIFFERS_FROM_STABLE)) {
+				in_interaction = 0;
+				printf("log: g%d: interaction %d ends\n",
+					   g->gen, interaction_nr);
 			}
-			
-			compl_box_init (&temp_box [box_cnt], free_cells, max_compl);
-			compl_box_add_cell (&temp_box [box_cnt], onlist_x [obj_ix], onlist_y [obj_ix]);
-			box_of_cell [obj_ix] = box_cnt;
-			box_cnt++;
 		}
 	}
 	
-	// Here we should first try to merge boxes to reduce the number of boxes and/or the total complexity of them
+	// find the first active generation
+	for(g = u_evolving->first; g && !(g->flags & DIFFERS_FROM_STABLE); g = g->next)
+		;
 	
-	if (box_cnt > max_local_rects)
-		return COMPL_FAILED_TOO_MANY_RECTS;
+	if(!g)
+		return 0;
 	
-	if (max_overall_local_compl != PARM_DISABLED)
-	{
-		int overall_compl = 0;
-		int box_ix;
-		for (box_ix = 0; box_ix < box_cnt; box_ix++)
-			overall_compl += compl_box_size_compl (&temp_box [box_ix]);
-		
-		overall_compl += highest_of (0, onlist_cnt - LOCAL_COMPL_OVERALL_FREE_CELLS);
-		if (overall_compl > max_overall_local_compl)
-			return COMPL_FAILED_OVERALL_LOCALLY;
+	ac_first = g->gen;
+	if(verbose > 0)
+		printf("First active generation: %d\n", ac_first);
+	
+	// find the generation after the last active generation
+	g_last = g;
+	for(; g; g = g->next) {
+		if(g->flags & DIFFERS_FROM_STABLE)
+			g_last = g;
 	}
 	
-	return COMPL_OK;
+	if(!g_last)
+		return 1;
+	
+	g = g_last->next ? g_last->next : g_last;
+	ac_last = g->gen;
+	if(verbose > 0)
+		printf("Last active generation: %d\n", ac_last);
+	
+	klass = (2 * ac_first) + (3 * ac_last);
+	
+	// The catalyst has returned to its stable state. Any
+	// remaining differences are the generated spark.
+	
+	// We calculate a hash for each tile independently,
+	// and sum them; this way the result is independent of
+	// the order in which we traverse the tiles.
+	
+	for(t = g->all_first; t; t = t->all_next)
+		klass += spark_tile_hash (t, universe_find_tile (u_static, 0, t->xpos, t->ypos, 0));
+	
+	return klass;
 }
 
-static compl_result test_compl ()
+// Inputs with the same hash, in the order of their first input, for --dedup
+typedef struct dedup_class_s {
+	uint32_t klass;
+	int count;
+	char *first_name;
+	struct dedup_class_s *next, *hashnext;
+} dedup_class;
+
+#define DEDUP_HASH_SIZE 65536
+
+static dedup_class *dedup_hash [DEDUP_HASH_SIZE];
+static dedup_class *dedup_first = NULL, *dedup_last = NULL;
+static int dedup_classes = 0;
+
+static void add_dedup_class (uint32_t klass, const char *name)
 {
-	if (max_local_rect_compl != PARM_DISABLED || max_overall_local_compl != PARM_DISABLED)
-	{
-		compl_result loc_result = test_compl_locally ();
-		if (loc_result != COMPL_OK)
-			return loc_result;
-	}
+	dedup_class *d;
 	
-	if (max_global_compl != PARM_DISABLED)
-	{
-		compl_box_init (&temp_box [0], GLOBAL_COMPL_FREE_CELLS, max_global_compl);
-		
-		int cell_ix;
-		for (cell_ix = 0; cell_ix < onlist_cnt; cell_ix++)
+	for (d = dedup_hash [klass & (DEDUP_HASH_SIZE - 1)]; d; d = d->hashnext)
+		if (d->klass == klass)
 		{
-			compl_box_add_cell (&temp_box [0], onlist_x [cell_ix], onlist_y [cell_ix]);
-			if (!compl_box_within_limit (&temp_box [0]))
-				return COMPL_FAILED_GLOBALLY;
+			d->count++;
+			return;
 		}
+	
+	d = malloc (sizeof (dedup_class));
+	if (d)
+		d->first_name = strdup (name);
+	if (!d || !d->first_name)
+	{
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
 	}
-		
-	return COMPL_OK;
+	
+	d->klass = klass;
+	d->count = 1;
+	d->next = NULL;
+	d->hashnext = dedup_hash [klass & (DEDUP_HASH_SIZE - 1)];
+	dedup_hash [klass & (DEDUP_HASH_SIZE - 1)] = d;
+	
+	if (dedup_last)
+		dedup_last->next = d;
+	else
+		dedup_first = d;
+	dedup_last = d;
+	dedup_classes++;
 }
 
-
-static void bellman_choose_cells (universe *u, generation *g, int allow_new_oncells, int first_gen_with_unknown_cells, int first_next_sol_gen)
+// One line per hash: the hash, the number of inputs with it, and the first of them
+static void write_dedup_file (const char *name, int n_classified)
 {
-	// Look for a tile with some unknown cells.
-	
-	g = u_evolving->first;
-	
-	tile *t;
-	do {
-		for(t = g->all_first;
-			t && !(t->flags & HAS_UNKNOWN_CELLS);
-			t = t->all_next)
-			;
-		if(!t) g = g->next;
-	} while(g && !t);
+	dedup_class *d;
 	
-	if(!g)
+	FILE *f = fopen (name, "w");
+	if (!f)
 	{
-		// We got all the way to the end of the pattern. This should not happen anymore - all
-		// solutions should be found before here and anything else should already be pruned
-		// Remember and report when search completed
-		
-		got_to_end_of_pattern = YES;
-		return;
+		perror (name);
+		exit (-1);
 	}
 	
-	// Find an unknown successor cell that's in the neighbourhood
-	// of an unknown-stable predecessor cell.
+	for (d = dedup_first; d; d = d->next)
+		fprintf (f, "%08x %d %s\n", d->klass, d->count, d->first_name);
 	
-	assert_if_debug(t->prev != NULL);
+	fclose (f);
+	printf ("--- %d inputs have %d different hashes, written to %s\n", n_classified, dedup_classes, name);
+}
+
+static int n_classified = 0;
+
+// Starts the next input with empty universes
+static void reset_universes ()
+{
+	generation *g;
+	tile *t;
 	
-	int x, y, dx = 2, dy = 2;
+	for (g = u_static->first; g; g = g->next)
+		for (t = g->all_first; t; t = t->all_next)
+			free (t->stable_words);
 	
-	// Look for direct predecessors first ...
+	universe_free (u_static);
+	universe_free (u_evolving);
+	universe_free (u_forbidden);
 	
-	for(y=0; y<TILE_HEIGHT; y++) {
-		TILE_WORD is_unk = 0;
-		is_unk = t->bit1[y] & ~t->bit0[y];
-		if(is_unk) {
-			for(x = 0; x < TILE_WIDTH; x++) {
-				if((is_unk >> x) & 1) {
-					assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
-					// Now look for an unknown-stable cell near it.
-					if((x == 0) || (x == TILE_WIDTH-1) || (y == 0) || (y == TILE_HEIGHT-1)) {
-						fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", g->gen, x, y);
-						assert(0);
-					}
-					
-					
-					TRY(0, 0);
-				}
-			}
-			
-		}
-	}
+	u_static = universe_new(OFF);
+	u_evolving = universe_new(OFF);
+	u_forbidden = universe_new(OFF);
+}
+
+// Classifies the pattern that has been read into the universes
+static void classify_loaded (const char *name, int verbose, int batch, int dedup)
+{
+	if (n_classified == 0)
+		set_max_gens ();
+	
+	prepare_universes ();
 	
-	// ... then orthogonally adjacent cells ...
+	if (batch)
+		printf ("file: %s\n", name);
 	
-	for(y=0; y<TILE_HEIGHT; y++) {
-		TILE_WORD is_unk = 0;
-		is_unk = t->bit1[y] & ~t->bit0[y];
-		if(is_unk) {
-			for(x = 0; x < TILE_WIDTH; x++) {
-				if((is_unk >> x) & 1) {
-					assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
-					// Now look for an unknown-stable cell near it.
-					if((x == 0) || (x == TILE_WIDTH-1) || (y == 0) || (y == TILE_HEIGHT-1)) {
-						fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", g->gen, x, y);
-						assert(0);
-					}
-					
-					
-					TRY(1, 0);
-					TRY(0, 1);
-					TRY(-1, 0);
-					TRY(0, -1);
-				}
-			}
-			
-		}
-	}
+	uint32_t klass = classify_pattern (verbose);
+	printf ("hash: %08x\n", klass);
 	
-	// ... then diagonally adjacent ones.
+	if (dedup)
+		add_dedup_class (klass, name);
 	
-	for(y=0; y<TILE_HEIGHT; y++) {
-		TILE_WORD is_unk = 0;
-		is_unk = t->bit1[y] & ~t->bit0[y];
-		if(is_unk) {
-			for(x = 0; x < TILE_WIDTH; x++) {
-				if((is_unk >> x) & 1) {
-					assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
-					// Now look for an unknown-stable cell near it.
-					if((x == 0) || (x == TILE_WIDTH-1) || (y == 0) || (y == TILE_HEIGHT-1)) {
-						fprintf(stderr, "TODO: handle tile wrap! (%d, %d, %d)\n", g->gen, x, y);
-						assert(0);
-					}
-					
-					
-					TRY(-1, -1);
-					TRY(-1, 1);
-					TRY(1, -1);
-					TRY(1, 1);
-				}
-			}
-			
-		}
-	}
-		
-	fprintf(stderr, "Didn't find an unknown cell!\n");
-	assert(0);
-	return;
+	n_classified++;
+	reset_universes ();
+}
+
+// Sets the cells of a RESULT_FORMAT_COMPACT record in the universes, as the result text would
+static int read_compact_record (const uint8_t *record, size_t length)
+{
+	static const char cell_text [] = {'.', '*', '@', '?'}; // indexed by COMPACT_CELL_*
+	compact_result_header h;
+	size_t pos = sizeof h;
+	int i, x, y, n;
 	
-found:
-	assert_if_debug(tile_get_cell(t, x, y) == UNKNOWN);
-	assert_if_debug(tile_get_cell(t->prev, x+dx, y+dy) == UNKNOWN_STABLE);
-	assert_if_debug(tile_get_cell((tile *)t->auxdata, x+dx, y+dy) == UNKNOWN_STABLE);
+	if (length < sizeof h)
+		return NO;
 	
-	assert_if_debug(dx <= 1);
-	assert_if_debug(dy <= 1);
-	x += dx;
-	y += dy;
+	memcpy (&h, record, sizeof h);
+	if (h.tile_width != TILE_WIDTH || h.tile_height != TILE_HEIGHT)
+	{
+		fprintf (stderr, "Compact results are from a build with %d x %d tiles\n", h.tile_width, h.tile_height);
+		return NO;
+	}
 	
-	int xmirror[8], ymirror[8], n_sym, i;
+	for (i = 0; i < h.n_tiles; i++)
+	{
+		compact_tile_header th;
+		
+		if (pos + sizeof th > length)
+			return NO;
+		memcpy (&th, record + pos, sizeof th);
+		pos += sizeof th;
+		
+		// The tile is there even without any cells, as in the result text
+		read_cb (NULL, 'P', 0, th.xpos, th.ypos, '.');
+		
+		const uint8_t *cells = record + pos;
+		pos += (th.width * th.height + 3) / 4;
+		if (pos > length)
+			return NO;
+		
+		for (y = 0, n = 0; y < th.height; y++)
+			for (x = 0; x < th.width; x++, n++)
+			{
+				int code = (cells [n / 4] >> (2 * (n % 4))) & 3;
+				if (code != COMPACT_CELL_OFF)
+					read_cb (NULL, 'P', 0, th.xpos + th.left + x, th.ypos + th.top + y, cell_text [code]);
+			}
+	}
 	
-	n_sym = xy_symmetry(x, y, xmirror, ymirror);
+	return YES;
+}
+
+static void classify_stream (const char *name, FILE *index, int verbose, int dedup)
+{
+	result_index_entry e;
+	char *record = NULL;
+	size_t record_size = 0;
+	int first = YES;
 	
-	for(i = 0; i < n_sym; i++) {
-		if(tile_get_cell(t->prev, xmirror[i], ymirror[i]) != UNKNOWN_STABLE) {
-			fprintf(stderr, "Input region is asymmetric (%d,%d)=%d (%d,%d)=%d\n",
-					x, y, tile_get_cell(t->prev, x, y),
-					xmirror [i], ymirror [i], tile_get_cell(t->prev, xmirror [i], ymirror [i]));
-			exit(-1);
-		}
+	FILE *f = fopen (name, "rb");
+	if (!f)
+	{
+		perror (name);
+		exit (-1);
 	}
 	
+	char *record_name = malloc (strlen (name) + 16);
+	if (!record_name)
+	{
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
+	}
 	
-	// Recurse with the selected cell as ON
-	if (allow_new_oncells)
+	while (fread (&e, sizeof e, 1, index) == 1)
 	{
-		if (max_added_static_on == PARM_DISABLED || onlist_cnt + n_sym <= max_added_static_on)
+		// The #S lines at the start of the stream are the parameters
+		size_t length = (first && e.offset > e.length) ? e.offset : e.length;
+		if (length > record_size)
 		{
-			if (onlist_cnt + n_sym > MAX_MAX_ADDED_STATIC_ON)
-			{
-				fprintf (stderr, "On-cell list overflow\n");
-				assert (0);
-			}
-			
-			for(i = 0; i < n_sym; i++)
+			free (record);
+			record_size = length;
+			record = malloc (record_size);
+			if (!record)
 			{
-				onlist_x [onlist_cnt] = xmirror [i];
-				onlist_y [onlist_cnt] = ymirror [i];
-				onlist_cnt++;
+				fprintf (stderr, "Out of memory\n");
+				exit (-1);
 			}
-			
-			compl_result cr = test_compl ();
-			if (cr == COMPL_OK)
+		}
+		
+		if (first)
+		{
+			if (fread (record, 1, e.offset, f) != e.offset || !read_life105_text (record, e.offset, read_cb, (n_classified == 0) ? read_param_cb : NULL, NULL))
 			{
-				for(i = 0; i < n_sym; i++){
-					tile_set_cell(t->prev,  xmirror[i], ymirror[i], ON);
-					tile_set_cell((tile *)t->auxdata,  xmirror[i], ymirror[i], ON);
-				}
-				
-				g->prev->flags |= CHANGED;
-				
-				bellman_recurse(u, g->prev, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
+				fprintf (stderr, "%s: Bad results stream header\n", name);
+				exit (-1);
 			}
-			else if (cr == COMPL_FAILED_LOCAL_RECT)
-				prune_too_compl_local_rect++;
-			else if (cr == COMPL_FAILED_OVERALL_LOCALLY)
-				prune_too_compl_overall_locally++;
-			else if (cr == COMPL_FAILED_TOO_MANY_RECTS)
-				prune_too_many_local_rects++;
-			else if (cr == COMPL_FAILED_GLOBALLY)
-				prune_too_compl_globally++;
-			
-			onlist_cnt -= n_sym;
-			
+			first = NO;
+		}
+		
+		if (fseek64 (f, e.offset, SEEK_SET) != 0 || fread (record, 1, e.length, f) != e.length)
+		{
+			fprintf (stderr, "%s: Result %u is not in the results stream\n", name, e.id);
+			exit (-1);
 		}
+		
+		int ok;
+		if (e.format == RESULT_FORMAT_COMPACT)
+			ok = read_compact_record ((const uint8_t *) record, e.length);
 		else
-			prune_too_many_added_static_on++;
+			ok = read_life105_text (record, e.length, read_cb, NULL, NULL);
+		
+		if (!ok)
+		{
+			fprintf (stderr, "%s: Bad record for result %u\n", name, e.id);
+			exit (-1);
+		}
+		
+		sprintf (record_name, "%s:%u", name, e.id);
+		classify_loaded (record_name, verbose, YES, dedup);
 	}
-	else
-		prune_stopped_adding_oncells++;
 	
+	free (record);
+	free (record_name);
+	fclose (f);
+}
+
+// With more than one input, or a results stream, each hash has a "file:" line before it
+static int classify_inputs (int n_inputs, char *inputs [], int verbose, const char *dedup_file_name)
+{
+	int i;
 	
-	// Recurse with the selected cell as OFF
-	for(i = 0; i < n_sym; i++){
-		tile_set_cell(t->prev,  xmirror[i], ymirror[i], OFF);
-		tile_set_cell((tile *)t->auxdata,  xmirror[i], ymirror[i], OFF);
+	if (n_inputs < 1)
+	{
+		fprintf (stderr, "No input to classify\n");
+		return -1;
 	}
 	
-	g->prev->flags |= CHANGED;
-	
-	bellman_recurse(u, g->prev, allow_new_oncells, first_gen_with_unknown_cells, first_next_sol_gen);
-	
-	for(i = 0; i < n_sym; i++){
-		tile_set_cell(t->prev,  xmirror[i], ymirror[i], UNKNOWN_STABLE);
-		tile_set_cell((tile *)t->auxdata,  xmirror[i], ymirror[i], UNKNOWN_STABLE);
+	for (i = 0; i < n_inputs; i++)
+	{
+		char *idx_name = index_file_name (inputs [i]);
+		FILE *index = fopen (idx_name, "rb");
+		free (idx_name);
+		
+		if (index)
+		{
+			classify_stream (inputs [i], index, verbose, dedup_file_name != NULL);
+			fclose (index);
+			continue;
+		}
+		
+		FILE *f = fopen (inputs [i], "r");
+		if (!f)
+		{
+			perror (inputs [i]);
+			return -1;
+		}
+		
+		// Only the first input sets the parameters
+		if (!read_life105 (f, read_cb, (n_classified == 0) ? read_param_cb : NULL, NULL))
+			exit (-1);
+		
+		fclose (f);
+		classify_loaded (inputs [i], verbose, n_inputs > 1, dedup_file_name != NULL);
 	}
 	
-	g->prev->flags |= CHANGED;
+	if (dedup_file_name)
+		write_dedup_file (dedup_file_name, n_classified);
+	
+	return 0;
 }
 
 int main(int argc, char *argv[]) {
@@ -1828,6 +5301,10 @@ int main(int argc, char *argv[]) {
 			CLASSIFY
 	} mode = SEARCH;
 	int verbose = 0;
+	const char *library = NULL;
+	const char *deferred_input = NULL;
+	int n_workers = 1;
+	const char *dedup_file_name = NULL;
 	
 	start_time = time (NULL);
 	
@@ -1838,14 +5315,67 @@ int main(int argc, char *argv[]) {
 	
 	int c;
 	
-	while((c = getopt(argc, argv, "cv")) != -1) switch(c) {
+	static const struct option long_options [] = {
+		{"stats-file", required_argument, NULL, 's'},
+		{"node-budget", required_argument, NULL, 'n'},
+		{"bench", required_argument, NULL, 'B'},
+		{"dedup", required_argument, NULL, 'D'},
+		{NULL, 0, NULL, 0}
+	};
+	
+	while((c = getopt_long(argc, argv, "b:cd:j:l:n:o:s:v", long_options, NULL)) != -1) switch(c) {
+		case 'b':
+			results_stream_name = optarg;
+			compact_results = YES;
+			break;
+			
 		case 'c':
 			mode = CLASSIFY;
 			break;
 			
+		case 'd':
+			deferred_input = optarg;
+			break;
+			
+		case 'j':
+			n_workers = strtol (optarg, NULL, 10);
+			if (n_workers < 1)
+			{
+				fprintf (stderr, "The number of workers must be at least 1\n");
+				exit (-1);
+			}
+			break;
+			
+		case 'l':
+			library = optarg;
+			break;
+			
+		case 'o':
+			results_stream_name = optarg;
+			break;
+			
+		case 's':
+			open_stats_file (optarg);
+			break;
+			
+		case 'n':
+			node_budget = strtoull (optarg, NULL, 10);
+			break;
+			
+		case 'B':
+			bench_file_name = optarg;
+			break;
+			
+		case 'D':
+			dedup_file_name = optarg;
+			break;
+			
 		case 'v': verbose++; break;
 	}
 	
+	if (mode == CLASSIFY)
+		return classify_inputs (argc - optind, argv + optind, verbose, dedup_file_name);
+	
 	FILE *f = fopen(argv[optind], "r");
 	if(!f) {
 		perror(argv[optind]);
@@ -1857,210 +5387,100 @@ int main(int argc, char *argv[]) {
 	
 	fclose(f);
 	
-	if (!verify_and_fix_parameters ())
+	set_max_gens ();
+	prepare_universes ();
+	
+	printf ("=== %s, %s ===\n", program_name, version_string);
+	remove_unreachable_unknowns ();
+	
+	if (library)
+	{
+		n_catalysts = load_catalyst_library (library, &catalysts);
+		if (n_catalysts < 0)
+			exit (-1);
+		printf ("--- Placing catalysts from %s, %d orientations\n", library, n_catalysts);
+	}
+	
+	if (!verify_static_is_stable ())
+	{
+		fprintf (stderr, "Predefined static pattern is not stable\n");
 		exit (-1);
+	}
 	
-	if (accept1_inact_gens == PARM_DISABLED)
-		max_gens = max_last_act_gen + (accept2_act_inact_gens - 1) + 1;
-	else if (accept2_act_inact_gens == PARM_DISABLED)
-		max_gens = max_last_act_gen + accept1_inact_gens + 1;
-	else
-		max_gens = lowest_of (max_last_act_gen + (accept2_act_inact_gens - 1) + 1, max_last_act_gen + accept1_inact_gens + 1);
-
-	max_gens = highest_of (max_gens, u_filter->n_gens + 1);
+	printf ("--- Starting search, max generations = %d\n", max_gens);
+	start_status_timer ();
+	uint64_t search_start_ns = clock_ns ();
 	
-	universe_evolve_next(u_static);
+#ifdef _WIN32
+	if (n_workers > 1)
+		fprintf (stderr, "Note: worker processes are not supported on Windows, so generations are searched one at a time\n");
+#endif
+	if (n_workers > 1 && !strictly_gen_by_gen)
+		fprintf (stderr, "Note: worker processes are only used with parameter '%s'\n", PARM_STRICTLY_GEN_BY_GEN);
 	
-	int i;
-	int x, y;
-	generation *g;
-	tile *t, *tp;
+	// This used to be a call to bellman_choose_cells, but now we start at bellman_recurse instead
+	// because we don't know yet if there are any unknown cells
 	
-	g = universe_find_generation(u_static, 0, 0);
-	for(t = g->all_first; t; t = t->all_next) {
-		tile *t2 = universe_find_tile(u_forbidden, 0, t->xpos, t->ypos, 0);
-		if(t2) t->auxdata = t2;
+	if (deferred_input)
+	{
+		load_deferred_subtrees (deferred_input);
+		printf ("--- Searching %d deferred subtrees from %s\n", deferred_cnt, deferred_input);
+		revisit_deferred_subtrees ();
 	}
-	
-	for(i=0; i<max_gens; i++) {
-		universe_evolve_next(u_evolving);
-		
-		g = universe_find_generation(u_evolving, i, 0);
-		for(t = g->all_first; t; t = t->all_next) {
-			tile *t2 = universe_find_tile(u_static, 0, t->xpos, t->ypos, 0);
-			if(t2) t->auxdata = t2;
-			
-			t2 = universe_find_tile(u_filter, g->gen + 1, t->xpos, t->ypos, 0);
-			if(t2) t->filter = t2;
+#ifndef _WIN32
+	else if (strictly_gen_by_gen && n_workers > 1)
+		search_gens_in_parallel (n_workers);
+#endif
+	else if (strictly_gen_by_gen)
+	{
+		int sg;
+		for (sg = min_first_act_gen; sg <= max_first_act_gen; sg++)
+		{
+			last_new_gen_time = time (NULL);
+			printf ("\n--- Starting generation %d\n", sg);
+			current_single_gen = sg;
+			if (!bellman_search ())
+				break;
 		}
 	}
+	else
+		bellman_search ();
 	
-	/* set auxdata in the final generation: */
-	g = universe_find_generation(u_evolving, i, 0);
-	for(t = g->all_first; t; t = t->all_next) {
-		tile *t2 = universe_find_tile(u_static, 0, t->xpos, t->ypos, 0);
-		if(t2) t->auxdata = t2;
-		t->filter = NULL;
+	if (!deferred_input && deferred_cnt > 0 && (max_results == PARM_DISABLED || solcount < max_results))
+	{
+		if (revisit_deferred)
+			revisit_deferred_subtrees ();
+		else
+			printf ("\n--- Left %d deferred subtrees in %s, search them with -d %s\n", deferred_cnt, deferred_file_name, deferred_file_name);
 	}
 	
-	bellman_evolve_generations(u_evolving->first, max_gens);
+	close_results_stream ();
+	print_prune_counters (YES);
 	
-	int ac_first, ac_last;
-	uint32_t klass;
+	if (bench_file_name)
+		write_bench_record (argv [optind], clock_ns () - search_start_ns);
 	
-	switch(mode) {
-		case SEARCH:
-			printf ("=== %s, %s ===\n", program_name, version_string);
-			if (!verify_static_is_stable ())
-			{
-				fprintf (stderr, "Predefined static pattern is not stable\n");
-				exit (-1);
-			}
-			
-			printf ("--- Starting search, max generations = %d\n", max_gens);
-			
-			// This used to be a call to bellman_choose_cells, but now we start at bellman_recurse instead
-			// because we don't know yet if there are any unknown cells
-			
-			if (strictly_gen_by_gen)
-			{
-				int sg;
-				for (sg = min_first_act_gen; sg <= max_first_act_gen; sg++)
-				{
-					last_new_gen_time = time (NULL);
-					printf ("\n--- Starting generation %d\n", sg);
-					current_single_gen = sg;
-					if (!bellman_recurse (u_evolving, u_evolving->first, YES, 0, 0))
-						break;
-				}
-			}
-			else
-				bellman_recurse (u_evolving, u_evolving->first, YES, 0, 0);
-			
-			print_prune_counters (YES);
-			
-			if (got_to_end_of_pattern)
-			{
-				fprintf (stderr, "\n\n");
-				fprintf (stderr, "=== Warning: At some point Bellman_szlim got to the last generation while\n");
-				fprintf (stderr, "             searching. This corresponds to the Type 1 solutions of\n");
-				fprintf (stderr, "             previous Bellman versions. The search continued with no\n");
-				fprintf (stderr, "             adverse effects, but this really shouldn't happen anymore.\n");
-				fprintf (stderr, "=== Please report this as a bug!\n");
-				fprintf (stderr, "=== Supply the input file and state the version number ""%s""\n\n", version_string);
-			}
-			
-			if (max_results != PARM_DISABLED && solcount >= max_results)
-				fprintf (stderr, "\n--- Interrupted because max allowed number of solutions was reached\n");
-			
-			break;
-			
-		case CLASSIFY:
-			
-			if(verbose > 0) {
-				if(verbose > 1)
-					dump(YES);
-				for(g = u_evolving->first; g; g = g->next) {
-					printf("Generation %d: %x: %s\n", g->gen, g->flags, flag2str(g->flags));
-				}
-				
-			}
-			
-			// print the history
-			int in_interaction = 0, interaction_nr = 0;
-			
-			for(g = u_evolving->first->next; g; g = g->next) {
-				if(!(g->flags & IS_LIVE)) {
-					printf("log: g%d: died out\n", g->gen);
-					break;
-				}
-				if(g->flags & HAS_UNKNOWN_CELLS) {
-					printf("log: g%d: became undetermined\n", g->gen);
-					break;
-				}
-				if(!(g->flags & DIFFERS_FROM_PREVIOUS)) {
-					printf("log: g%d: became stable\n", g->gen);
-					break;
-				}
-				if(!(g->flags & DIFFERS_FROM_2PREV)) {
-					printf("log: g%d: became period 2\n", g->gen);
-					break;
-				}
-				
-				if(!in_interaction) {
-					if(g->flags & DIFFERS_FROM_STABLE) {
-						interaction_nr++;
-						in_interaction = 1;
-						printf("log: g%d: interaction %d begins\n",
-							   g->gen, interaction_nr);
-					}
-				} else {
-					if(!(g->flags & DIFFERS_FROM_STABLE)) {
-						in_interaction = 0;
-						printf("log: g%d: interaction %d ends\n",
-							   g->gen, interaction_nr);
-					}
-				}
-			}
-			
-			// find the first active generation
-			for(g = u_evolving->first; g && !(g->flags & DIFFERS_FROM_STABLE); g = g->next)
-				;
-			generation *g_last;
-			
-			if(!g) {
-				klass = 0;
-				goto done;
-			}
-			ac_first = g->gen;
-			if(verbose > 0)
-				printf("First active generation: %d\n", ac_first);
-			
-			// find the generation after the last active generation
-			g_last = g;
-			for(; g; g = g->next) {
-				if(g->flags & DIFFERS_FROM_STABLE)
-					g_last = g;
-			}
-			
-			if(!g_last) {
-				klass = 1;
-				goto done;
-			}
-			
-			g = g_last->next ? g_last->next : g_last;
-			ac_last = g->gen;
-			if(verbose > 0)
-				printf("Last active generation: %d\n", ac_last);
-			
-			klass = (2 * ac_first) + (3 * ac_last);
-			
-			// The catalyst has returned to its stable state. Any
-			// remaining differences are the generated spark.
-			
-			// We calculate a hash for each tile independently,
-			// and sum them; this way the result is independent of
-			// the order in which we traverse the tiles.
-			
-			for(t = g->all_first; t; t = t->all_next) {
-				uint32_t hash = 1;
-				tp = universe_find_tile(u_static, 0, t->xpos, t->ypos, 1);
-				for(y=0; y<TILE_HEIGHT; y++) for(x=0; x<TILE_WIDTH; x++) {
-					cellvalue t1 = tile_get_cell(t, x, y);
-					cellvalue t2 = tile_get_cell(tp, x, y);
-					if(t1 != t2) {
-						hash = (hash ^ t1) * 0xabcdef13;
-						hash = (hash ^ t2) * 0xabcdef13;
-						hash = (hash ^ x) * 0xabcdef13;
-						hash = (hash ^ y) * 0xabcdef13;
-					}
-				}
-				klass += hash;
-			}
-
-done:
-			printf("hash: %08x\n", klass);
-			break;
+#ifdef PROFILE_SEARCH
+	// With worker processes, each of them writes its own profile
+	if (profile_nodes > 0)
+		write_profile ("profile.txt");
+#endif
+	
+	if (got_to_end_of_pattern)
+	{
+		fprintf (stderr, "\n\n");
+		fprintf (stderr, "=== Warning: At some point Bellman_szlim got to the last generation while\n");
+		fprintf (stderr, "             searching. This corresponds to the Type 1 solutions of\n");
+		fprintf (stderr, "             previous Bellman versions. The search continued with no\n");
+		fprintf (stderr, "             adverse effects, but this really shouldn't happen anymore.\n");
+		fprintf (stderr, "=== Please report this as a bug!\n");
+		fprintf (stderr, "=== Supply the input file and state the version number ""%s""\n\n", version_string);
 	}
+	
+	if (max_results != PARM_DISABLED && solcount >= max_results)
+		fprintf (stderr, "\n--- Interrupted because max allowed number of solutions was reached\n");
+	else if (node_budget && recurse_nodes >= node_budget)
+		fprintf (stderr, "\n--- Stopped after the node budget of %" PRIu64 " nodes\n", node_budget);
+	
 	return 0;
 }
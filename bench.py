@@ -0,0 +1,81 @@
+# Benchmark suite for bellman.
+#
+# Runs bellman on each input for a fixed number of search nodes (or to the end of the search,
+# if that comes first), and writes one JSON file with a record per input, so that runs of
+# different commits or on different machines can be compared. The search is deterministic, so
+# with the same node budget, two builds that search the same way report the same nodes, prunes
+# and solution checksum, and only the speed differs.
+#
+# python bench.py [-b bellman] [-n node-budget] [-o bench.json] [input ...]
+#
+# Without inputs, all inputs in the inputs directory are used.
+
+import sys, os, glob, json, platform, subprocess, shutil, tempfile, argparse
+
+def default_inputs ():
+	here = os.path.dirname (os.path.abspath (__file__))
+	files = sorted (glob.glob (os.path.join (here, "inputs", "*.in")))
+	files += sorted (glob.glob (os.path.join (here, "inputs", "*_test.txt")))
+	return files
+
+def git_commit ():
+	try:
+		return subprocess.check_output (["git", "rev-parse", "--short", "HEAD"], cwd = os.path.dirname (os.path.abspath (__file__)), stderr = subprocess.DEVNULL).decode ().strip ()
+	except (OSError, subprocess.CalledProcessError):
+		return None
+
+def run_input (bellman, infile, node_budget):
+	# Each run gets its own directory, for its result files
+	workdir = tempfile.mkdtemp (prefix = "bench-")
+	record_file = os.path.join (workdir, "bench.json")
+	try:
+		args = [bellman, "--bench", record_file]
+		if node_budget > 0:
+			args += ["--node-budget", str (node_budget)]
+		args.append (infile)
+		subprocess.run (args, cwd = workdir, stdout = subprocess.DEVNULL, stderr = subprocess.DEVNULL)
+		with open (record_file) as f:
+			record = json.loads (f.readline ())
+		record ["input"] = os.path.basename (infile)
+		return record
+	except (OSError, ValueError) as e:
+		print ("%s: no benchmark record (%s)" % (infile, e), file = sys.stderr)
+		return None
+	finally:
+		shutil.rmtree (workdir, ignore_errors = True)
+
+def main ():
+	exe = "bellman.exe" if os.name == "nt" else "./bellman"
+	parser = argparse.ArgumentParser (description = "Run the bellman benchmark suite")
+	parser.add_argument ("-b", "--bellman", default = exe, help = "bellman executable (default %s)" % exe)
+	parser.add_argument ("-n", "--node-budget", type = int, default = 100000, help = "search nodes per input, 0 to search to the end (default 100000)")
+	parser.add_argument ("-o", "--output", default = "bench.json", help = "JSON file to write (default bench.json)")
+	parser.add_argument ("inputs", nargs = "*")
+	args = parser.parse_args ()
+
+	bellman = os.path.abspath (args.bellman)
+	inputs = [os.path.abspath (i) for i in args.inputs] or default_inputs ()
+
+	runs = []
+	print ("%-16s %10s %12s %12s %10s %10s %5s  %s" % ("input", "nodes", "nodes/s", "prunes/s", "tiles/node", "peak KB", "sols", "checksum"))
+	for infile in inputs:
+		r = run_input (bellman, infile, args.node_budget)
+		if not r:
+			continue
+		runs.append (r)
+		print ("%-16s %10d %12.0f %12.0f %10.2f %10d %5d  %s%s" % (r ["input"], r ["nodes"], r ["nodes_per_sec"], r ["prunes_per_sec"], r ["tiles_per_node"], r ["peak_memory_kb"], r ["solutions"], r ["checksum"], "" if r ["completed"] else " (stopped)"))
+
+	report = {
+		"commit": git_commit (),
+		"machine": platform.machine (),
+		"processor": platform.processor (),
+		"system": platform.platform (),
+		"node_budget": args.node_budget,
+		"runs": runs
+	}
+	with open (args.output, "w") as f:
+		json.dump (report, f, indent = 1)
+	print ("Wrote %s" % args.output)
+
+if __name__ == "__main__":
+	main ()
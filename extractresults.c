@@ -0,0 +1,564 @@
+// 64-bit file offsets for fseeko on 32-bit systems
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "resultstream.h"
+
+// Turn a results stream written by bellman -o or -b back into separate result files.
+//
+// extractresults [-l] [-f format] stream [first [last]]
+//   -l  List the solutions in the index instead of writing result files
+//   -f  out: result files the same as bellman writes without -o (default)
+//       lif: Life 1.05 files of generation 0
+//       rle: RLE files of generation 0
+
+#define YES 1
+#define NO 0
+
+// Streams with many results are larger than 2 GB, more than a 32-bit long can seek to
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#else
+#define fseek64 fseeko
+#endif
+
+typedef enum {FORMAT_OUT, FORMAT_LIFE105, FORMAT_RLE} output_format;
+
+// One tile of a result, the bounding box of its cells as '.', '*', '@' and '?'
+typedef struct {
+	int xpos, ypos;
+	int left, top, width, height;
+	char *cells;
+} result_tile;
+
+typedef struct {
+	int accept_gen, max_active, glider_count;
+	int act_count, act_gen [COMPACT_MAX_ACTIVATIONS];
+	int tile_width, tile_height;
+	int n_tiles;
+	result_tile *tiles;
+} result;
+
+static void *alloc_or_die (size_t size)
+{
+	void *p = calloc (1, size ? size : 1);
+	if (!p)
+	{
+		fprintf (stderr, "Out of memory\n");
+		exit (-1);
+	}
+
+	return p;
+}
+
+static char *read_bytes (FILE *f, const char *name, uint64_t offset, uint32_t length)
+{
+	char *buf = alloc_or_die (length + 1);
+
+	if (fseek64 (f, offset, SEEK_SET) != 0 || fread (buf, 1, length, f) != length)
+	{
+		fprintf (stderr, "Can't read %u bytes at offset %llu from %s\n", length, (unsigned long long) offset, name);
+		exit (-1);
+	}
+
+	buf [length] = '\0';
+	return buf;
+}
+
+static void bad_record (const result_index_entry *e)
+{
+	fprintf (stderr, "Result %u is damaged\n", e->id);
+	exit (-1);
+}
+
+// The result file names depend on the new-result-naming parameter in the #S lines
+static int uses_new_result_naming (const char *header)
+{
+	const char *p = strstr (header, "#S new-result-naming ");
+	return p && atoi (p + strlen ("#S new-result-naming ")) > 0;
+}
+
+static void decode_compact (const result_index_entry *e, const char *rec, result *r)
+{
+	const char *p = rec, *end = rec + e->length;
+	compact_result_header h;
+	int i;
+
+	if (end - p < (long) sizeof h)
+		bad_record (e);
+	memcpy (&h, p, sizeof h);
+	p += sizeof h;
+
+	if (h.act_count < 0 || h.act_count > COMPACT_MAX_ACTIVATIONS || h.n_tiles < 0)
+		bad_record (e);
+
+	r->accept_gen = h.accept_gen;
+	r->max_active = h.max_active;
+	r->glider_count = h.glider_count;
+	r->act_count = h.act_count;
+	memcpy (r->act_gen, h.act_gen, sizeof r->act_gen);
+	r->tile_width = h.tile_width;
+	r->tile_height = h.tile_height;
+	r->n_tiles = h.n_tiles;
+	r->tiles = alloc_or_die (h.n_tiles * sizeof (result_tile));
+
+	for (i = 0; i < h.n_tiles; i++)
+	{
+		static const char cell_chars [] = ".*@?";
+		result_tile *t = &r->tiles [i];
+		compact_tile_header th;
+		int n;
+
+		if (end - p < (long) sizeof th)
+			bad_record (e);
+		memcpy (&th, p, sizeof th);
+		p += sizeof th;
+
+		if (th.width < 0 || th.height < 0 || th.left + th.width > h.tile_width || th.top + th.height > h.tile_height)
+			bad_record (e);
+
+		t->xpos = th.xpos;
+		t->ypos = th.ypos;
+		t->left = th.left;
+		t->top = th.top;
+		t->width = th.width;
+		t->height = th.height;
+		t->cells = alloc_or_die (th.width * th.height);
+
+		if (end - p < (th.width * th.height + 3) / 4)
+			bad_record (e);
+
+		for (n = 0; n < th.width * th.height; n++)
+			t->cells [n] = cell_chars [(p [n / 4] >> (2 * (n % 4))) & 3];
+		p += (th.width * th.height + 3) / 4;
+	}
+}
+
+// The same, from the text of a result file
+static void decode_text (const result_index_entry *e, char *rec, result *r)
+{
+	result_tile *t = NULL;
+	char *line, *next;
+	int y = 0;
+
+	memset (r, 0, sizeof *r);
+
+	for (line = rec; *line; line = next)
+	{
+		next = strchr (line, '\n');
+		if (next)
+			*next++ = '\0';
+		else
+			next = line + strlen (line);
+
+		if (line [0] == '#')
+		{
+			if (sscanf (line, "#C Solution accepted at generation %d", &r->accept_gen) == 1
+			 || sscanf (line, "#C Max active cells %d", &r->max_active) == 1
+			 || sscanf (line, "#C Glider count at accept %d", &r->glider_count) == 1)
+				continue;
+
+			if (strncmp (line, "#C Activations at generation ", 29) == 0)
+			{
+				char *p = line + 29;
+				while (r->act_count < COMPACT_MAX_ACTIVATIONS && *p)
+				{
+					r->act_gen [r->act_count++] = strtol (p, &p, 10);
+					while (*p == ',' || *p == ' ')
+						p++;
+				}
+			}
+			else if (line [1] == 'P')
+			{
+				r->tiles = realloc (r->tiles, (r->n_tiles + 1) * sizeof (result_tile));
+				if (!r->tiles)
+				{
+					fprintf (stderr, "Out of memory\n");
+					exit (-1);
+				}
+
+				t = &r->tiles [r->n_tiles++];
+				memset (t, 0, sizeof *t);
+				if (sscanf (line, "#P %d %d", &t->xpos, &t->ypos) != 2)
+					bad_record (e);
+				y = 0;
+			}
+			continue;
+		}
+
+		if (!t)
+			bad_record (e);
+
+		// Keep the whole tile for now, it is cut to the bounding box below
+		if (y == 0)
+			t->width = strlen (line);
+		if (t->width > r->tile_width)
+			r->tile_width = t->width;
+
+		t->cells = realloc (t->cells, (y + 1) * t->width);
+		if (!t->cells)
+		{
+			fprintf (stderr, "Out of memory\n");
+			exit (-1);
+		}
+
+		memset (t->cells + y * t->width, '.', t->width);
+		memcpy (t->cells + y * t->width, line, strlen (line) < (size_t) t->width ? strlen (line) : (size_t) t->width);
+		t->height = y + 1;
+		if (t->height > r->tile_height)
+			r->tile_height = t->height;
+		y++;
+	}
+
+	int i;
+	for (i = 0; i < r->n_tiles; i++)
+	{
+		result_tile *tt = &r->tiles [i];
+		int left = tt->width, right = -1, top = tt->height, bottom = -1;
+		int x;
+
+		for (y = 0; y < tt->height; y++)
+			for (x = 0; x < tt->width; x++)
+				if (tt->cells [y * tt->width + x] != '.')
+				{
+					if (x < left) left = x;
+					if (x > right) right = x;
+					if (y < top) top = y;
+					bottom = y;
+				}
+
+		if (right < 0)
+		{
+			tt->left = tt->top = tt->width = tt->height = 0;
+			continue;
+		}
+
+		for (y = top; y <= bottom; y++)
+			memmove (tt->cells + (y - top) * (right - left + 1), tt->cells + y * tt->width + left, right - left + 1);
+
+		tt->left = left;
+		tt->top = top;
+		tt->width = right - left + 1;
+		tt->height = bottom - top + 1;
+	}
+}
+
+static void free_result (result *r)
+{
+	int i;
+	for (i = 0; i < r->n_tiles; i++)
+		free (r->tiles [i].cells);
+	free (r->tiles);
+}
+
+static char tile_cell (const result_tile *t, int x, int y)
+{
+	if (x < t->left || x >= t->left + t->width || y < t->top || y >= t->top + t->height)
+		return '.';
+
+	return t->cells [(y - t->top) * t->width + (x - t->left)];
+}
+
+static int is_live (char c)
+{
+	return c == '*' || c == '@';
+}
+
+static void print_comments (FILE *f, const char *prefix, const result *r)
+{
+	int i;
+
+	fprintf (f, "%s Solution accepted at generation %d\n", prefix, r->accept_gen);
+	fprintf (f, "%s Activations at generation ", prefix);
+	for (i = 0; i < r->act_count; i++)
+		fprintf (f, i < r->act_count - 1 ? "%d, " : "%d\n", r->act_gen [i]);
+	fprintf (f, "%s Max active cells %d\n", prefix, r->max_active);
+	fprintf (f, "%s Glider count at accept %d\n", prefix, r->glider_count);
+}
+
+// The header ends with the "#C Search made using" line in a compact stream
+static void write_out (FILE *f, const char *header, const result *r)
+{
+	int i, x, y;
+
+	fputs (header, f);
+	print_comments (f, "#C", r);
+
+	for (i = 0; i < r->n_tiles; i++)
+	{
+		const result_tile *t = &r->tiles [i];
+
+		fprintf (f, "#P %d %d\n", t->xpos, t->ypos);
+		for (y = 0; y < r->tile_height; y++)
+		{
+			for (x = 0; x < r->tile_width; x++)
+				fputc (tile_cell (t, x, y), f);
+			fputc ('\n', f);
+		}
+	}
+}
+
+static void write_life105 (FILE *f, const result *r)
+{
+	int i, x, y;
+
+	fprintf (f, "#Life 1.05\n");
+	print_comments (f, "#D", r);
+	fprintf (f, "#N\n");
+
+	for (i = 0; i < r->n_tiles; i++)
+	{
+		const result_tile *t = &r->tiles [i];
+		if (t->width == 0)
+			continue;
+
+		fprintf (f, "#P %d %d\n", t->xpos + t->left, t->ypos + t->top);
+		for (y = 0; y < t->height; y++)
+		{
+			for (x = 0; x < t->width; x++)
+				fputc (is_live (t->cells [y * t->width + x]) ? '*' : '.', f);
+			fputc ('\n', f);
+		}
+	}
+}
+
+// RLE output, with lines of at most 70 characters
+static int rle_col;
+
+static void rle_put (FILE *f, int count, char c)
+{
+	char buf [16];
+	int len;
+
+	if (count > 1)
+		len = sprintf (buf, "%d%c", count, c);
+	else
+		len = sprintf (buf, "%c", c);
+
+	if (rle_col + len > 70)
+	{
+		fputc ('\n', f);
+		rle_col = 0;
+	}
+
+	fputs (buf, f);
+	rle_col += len;
+}
+
+static void write_rle (FILE *f, const result *r)
+{
+	int left = 0, right = -1, top = 0, bottom = -1;
+	int i, x, y;
+
+	for (i = 0; i < r->n_tiles; i++)
+	{
+		const result_tile *t = &r->tiles [i];
+		for (y = 0; y < t->height; y++)
+			for (x = 0; x < t->width; x++)
+				if (is_live (t->cells [y * t->width + x]))
+				{
+					int cx = t->xpos + t->left + x, cy = t->ypos + t->top + y;
+
+					if (right < left)
+					{
+						left = right = cx;
+						top = bottom = cy;
+					}
+					if (cx < left) left = cx;
+					if (cx > right) right = cx;
+					if (cy < top) top = cy;
+					if (cy > bottom) bottom = cy;
+				}
+	}
+
+	int wd = right - left + 1, ht = bottom - top + 1;
+	char *grid = alloc_or_die (wd * ht);
+
+	for (i = 0; i < r->n_tiles; i++)
+	{
+		const result_tile *t = &r->tiles [i];
+		for (y = 0; y < t->height; y++)
+			for (x = 0; x < t->width; x++)
+				if (is_live (t->cells [y * t->width + x]))
+					grid [(t->ypos + t->top + y - top) * wd + (t->xpos + t->left + x - left)] = 1;
+	}
+
+	print_comments (f, "#C", r);
+	fprintf (f, "x = %d, y = %d, rule = B3/S23\n", wd, ht);
+
+	int blank_rows = 0;
+	rle_col = 0;
+	for (y = 0; y < ht; y++)
+	{
+		const char *row = grid + y * wd;
+		int end = wd;
+
+		while (end > 0 && !row [end - 1])
+			end--;
+
+		if (end == 0)
+		{
+			blank_rows++;
+			continue;
+		}
+
+		if (y > 0)
+			rle_put (f, blank_rows + 1, '$');
+		blank_rows = 0;
+
+		for (x = 0; x < end; )
+		{
+			int run = 1;
+			while (x + run < end && row [x + run] == row [x])
+				run++;
+			rle_put (f, run, row [x] ? 'o' : 'b');
+			x += run;
+		}
+	}
+
+	rle_put (f, 1, '!');
+	fputc ('\n', f);
+	free (grid);
+}
+
+static void usage (const char *prog)
+{
+	fprintf (stderr, "Usage: %s [-l] [-f out|lif|rle] stream [first [last]]\n", prog);
+	exit (-1);
+}
+
+int main (int argc, char *argv [])
+{
+	output_format format = FORMAT_OUT;
+	int list = NO;
+	int c;
+
+	while ((c = getopt (argc, argv, "f:l")) != -1) switch (c)
+	{
+		case 'f':
+			if (strcmp (optarg, "out") == 0)
+				format = FORMAT_OUT;
+			else if (strcmp (optarg, "lif") == 0)
+				format = FORMAT_LIFE105;
+			else if (strcmp (optarg, "rle") == 0)
+				format = FORMAT_RLE;
+			else
+				usage (argv [0]);
+			break;
+
+		case 'l':
+			list = YES;
+			break;
+
+		default:
+			usage (argv [0]);
+	}
+
+	if (optind >= argc)
+		usage (argv [0]);
+
+	const char *name = argv [optind];
+	unsigned long first = (optind + 1 < argc) ? strtoul (argv [optind + 1], NULL, 10) : 1;
+	unsigned long last = (optind + 2 < argc) ? strtoul (argv [optind + 2], NULL, 10) : (optind + 1 < argc ? first : (unsigned long) -1);
+
+	char *idx_name = alloc_or_die (strlen (name) + 5);
+	sprintf (idx_name, "%s.idx", name);
+
+	FILE *f = fopen (name, "rb");
+	if (!f)
+	{
+		perror (name);
+		return -1;
+	}
+
+	FILE *fi = fopen (idx_name, "rb");
+	if (!fi)
+	{
+		perror (idx_name);
+		return -1;
+	}
+
+	result_index_entry e;
+	char *header = NULL;
+	int new_naming = NO;
+	int n_written = 0;
+
+	while (fread (&e, sizeof e, 1, fi) == 1)
+	{
+		// The #S lines are everything before the first result
+		if (!header)
+		{
+			header = read_bytes (f, name, 0, (uint32_t) e.offset);
+			new_naming = uses_new_result_naming (header);
+		}
+
+		if (e.id < first || e.id > last)
+			continue;
+
+		if (list)
+		{
+			printf ("%6u: accepted at gen %d, gliders %d, max active cells %d\n", e.id, e.accept_gen, e.glider_count, e.max_active);
+			continue;
+		}
+
+		char out_name [40];
+		if (format == FORMAT_LIFE105)
+			snprintf (out_name, sizeof out_name, "result%06u.lif", e.id);
+		else if (format == FORMAT_RLE)
+			snprintf (out_name, sizeof out_name, "result%06u.rle", e.id);
+		else if (new_naming)
+			snprintf (out_name, sizeof out_name, "result%06u.out", e.id);
+		else
+			snprintf (out_name, sizeof out_name, "result%06u-4.out", e.id);
+
+		char *rec = read_bytes (f, name, e.offset, e.length);
+
+		FILE *out = fopen (out_name, "w");
+		if (!out)
+		{
+			perror (out_name);
+			return -1;
+		}
+
+		if (format == FORMAT_OUT && e.format == RESULT_FORMAT_TEXT)
+		{
+			fputs (header, out);
+			fwrite (rec, 1, e.length, out);
+		}
+		else
+		{
+			result r;
+
+			if (e.format == RESULT_FORMAT_COMPACT)
+				decode_compact (&e, rec, &r);
+			else
+				decode_text (&e, rec, &r);
+
+			if (format == FORMAT_OUT)
+				write_out (out, header, &r);
+			else if (format == FORMAT_LIFE105)
+				write_life105 (out, &r);
+			else
+				write_rle (out, &r);
+
+			free_result (&r);
+		}
+
+		fclose (out);
+		free (rec);
+		n_written++;
+	}
+
+	if (!list)
+		printf ("Wrote %d result files\n", n_written);
+
+	free (header);
+	free (idx_name);
+	fclose (fi);
+	fclose (f);
+
+	return 0;
+}
@@ -1,4 +1,8 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "universe.h"
+#include "fixedcats.h"
 
 #define YES 1
 #define NO 0
@@ -209,3 +213,240 @@ int ver_cats (generation *ge)
 						return NO;
 	return YES;
 }
+
+// A catalyst library file lists catalysts in a single orientation each, separated by blank
+// lines, with an optional "#N name" line before each one. Catalyst cells are drawn as '*',
+// '@' or 'O', cells that must be Off as '.', cells that must already be Off as 'x' and don't
+// care cells as '?'. Every cell next to a catalyst cell must be Off too, even if it isn't
+// drawn. All eight orientations of each catalyst are added, without duplicates.
+
+#define MAX_DRAWN_SIZE (MAX_CATALYST_SIZE - 2)
+
+static int add_orientation (catalyst **cats, int n_cats, const char *name, int mask [MAX_CATALYST_SIZE] [MAX_CATALYST_SIZE], int wd, int ht, int symi)
+{
+	catalyst c;
+	int x;
+	int y;
+	int i;
+	
+	memset (&c, 0, sizeof c);
+	snprintf (c.name, sizeof c.name, "%s", name);
+	c.wd = (symi & 4) ? ht : wd;
+	c.ht = (symi & 4) ? wd : ht;
+	
+	for (y = 0; y < c.ht; y++)
+		for (x = 0; x < c.wd; x++)
+		{
+			int sx = (symi & 4) ? y : x;
+			int sy = (symi & 4) ? x : y;
+			if (symi & 1)
+				sx = wd - 1 - sx;
+			if (symi & 2)
+				sy = ht - 1 - sy;
+			
+			TILE_WORD bit = ((TILE_WORD) 1) << x;
+			switch (mask [sy] [sx])
+			{
+				case 1:
+					c.on_bits [y] |= bit;
+					c.on_x [c.n_on] = x;
+					c.on_y [c.n_on] = y;
+					c.n_on++;
+					break;
+				case 2:
+					c.must_off_bits [y] |= bit;
+					break;
+				case 4:
+					c.off_bits [y] |= bit;
+					break;
+			}
+		}
+	
+	for (i = 0; i < n_cats; i++)
+		if ((*cats) [i].wd == c.wd && (*cats) [i].ht == c.ht &&
+			!memcmp ((*cats) [i].on_bits, c.on_bits, sizeof c.on_bits) &&
+			!memcmp ((*cats) [i].off_bits, c.off_bits, sizeof c.off_bits) &&
+			!memcmp ((*cats) [i].must_off_bits, c.must_off_bits, sizeof c.must_off_bits))
+				return n_cats;
+	
+	catalyst *more = realloc (*cats, (n_cats + 1) * sizeof c);
+	if (!more)
+	{
+		fprintf (stderr, "out of memory\n");
+		exit (-1);
+	}
+	*cats = more;
+	(*cats) [n_cats] = c;
+	return n_cats + 1;
+}
+
+static int add_catalyst (catalyst **cats, int n_cats, const char *name, int drawn [MAX_DRAWN_SIZE] [MAX_DRAWN_SIZE], int wd, int ht)
+{
+	int mask [MAX_CATALYST_SIZE] [MAX_CATALYST_SIZE];
+	int n_on = 0;
+	int x;
+	int y;
+	int symi;
+	
+	// Leave room for the Off cells around the catalyst
+	memset (mask, 0, sizeof mask);
+	for (y = 0; y < ht; y++)
+		for (x = 0; x < wd; x++)
+		{
+			mask [y + 1] [x + 1] = drawn [y] [x];
+			if (drawn [y] [x] == 1)
+				n_on++;
+		}
+	
+	if (n_on == 0 || n_on > MAX_CATALYST_ON_CELLS)
+	{
+		fprintf (stderr, "Catalyst '%s' must have 1 to %d On cells\n", name, MAX_CATALYST_ON_CELLS);
+		return -1;
+	}
+	
+	wd += 2;
+	ht += 2;
+	for (y = 0; y < ht; y++)
+		for (x = 0; x < wd; x++)
+			if (mask [y] [x] == 0)
+			{
+				int nx;
+				int ny;
+				for (ny = y - 1; ny <= y + 1; ny++)
+					for (nx = x - 1; nx <= x + 1; nx++)
+						if (nx >= 0 && nx < wd && ny >= 0 && ny < ht && mask [ny] [nx] == 1)
+							mask [y] [x] = 4;
+			}
+	
+	for (symi = 0; symi < 8; symi++)
+		n_cats = add_orientation (cats, n_cats, name, mask, wd, ht, symi);
+	
+	return n_cats;
+}
+
+int load_catalyst_library (const char *filename, catalyst **cats)
+{
+	int drawn [MAX_DRAWN_SIZE] [MAX_DRAWN_SIZE];
+	char linebuff [256];
+	char name [32];
+	int n_cats = 0;
+	int n_drawn = 0;
+	int wd = 0;
+	int ht = 0;
+	int x;
+	
+	FILE *f = fopen (filename, "r");
+	if (!f)
+	{
+		perror (filename);
+		return -1;
+	}
+	
+	*cats = NULL;
+	memset (drawn, 0, sizeof drawn);
+	strcpy (name, "catalyst");
+	
+	int done = NO;
+	while (!done)
+	{
+		if (!fgets (linebuff, sizeof linebuff, f))
+		{
+			done = YES;
+			linebuff [0] = 0;
+		}
+		
+		char *p = strchr (linebuff, '\r');
+		if (p) *p = 0;
+		p = strchr (linebuff, '\n');
+		if (p) *p = 0;
+		
+		if (linebuff [0] == '#')
+		{
+			if (linebuff [1] == 'N' && ht == 0)
+			{
+				for (p = linebuff + 2; *p == ' '; p++)
+					;
+				snprintf (name, sizeof name, "%.31s", p);
+			}
+			continue;
+		}
+		
+		if (linebuff [strspn (linebuff, " \t")] == 0)
+		{
+			if (ht > 0)
+			{
+				n_cats = add_catalyst (cats, n_cats, name, drawn, wd, ht);
+				if (n_cats < 0)
+					break;
+				n_drawn++;
+				snprintf (name, sizeof name, "catalyst %d", n_drawn + 1);
+			}
+			memset (drawn, 0, sizeof drawn);
+			wd = 0;
+			ht = 0;
+			continue;
+		}
+		
+		if (ht >= MAX_DRAWN_SIZE || (int) strlen (linebuff) > MAX_DRAWN_SIZE)
+		{
+			fprintf (stderr, "Catalyst '%s' is larger than %d by %d cells\n", name, MAX_DRAWN_SIZE, MAX_DRAWN_SIZE);
+			n_cats = -1;
+			break;
+		}
+		
+		for (x = 0; linebuff [x]; x++)
+			switch (linebuff [x])
+			{
+				case '*': case '@': case 'O': case 'o':
+					drawn [ht] [x] = 1;
+					break;
+				case 'x': case 'X':
+					drawn [ht] [x] = 2;
+					break;
+				case '.':
+					drawn [ht] [x] = 4;
+					break;
+				case '?':
+					drawn [ht] [x] = 0;
+					break;
+				default:
+					fprintf (stderr, "Bad character '%c' in catalyst '%s'\n", linebuff [x], name);
+					fclose (f);
+					return -1;
+			}
+		
+		if (x > wd)
+			wd = x;
+		ht++;
+	}
+	
+	fclose (f);
+	
+	if (n_cats == 0)
+	{
+		fprintf (stderr, "No catalysts in %s\n", filename);
+		return -1;
+	}
+	
+	return n_cats;
+}
+
+// The placement of c with its top left corner at (x, y) must lie within t. It matches if
+// t has On or Unknown in the catalyst's cells, Off or Unknown around it, and Off in its
+// must-be-Off cells. Unknown cells in a static tile always have both bits set.
+
+int catalyst_matches (const catalyst *c, const tile *t, int x, int y)
+{
+	int cy;
+	
+	for (cy = 0; cy < c->ht; cy++)
+	{
+		TILE_WORD b0 = t->bit0 [y + cy] >> x;
+		TILE_WORD b1 = t->bit1 [y + cy] >> x;
+		
+		if ((c->on_bits [cy] & ~b0) || (c->off_bits [cy] & b0 & ~b1) || (c->must_off_bits [cy] & b0))
+			return NO;
+	}
+	
+	return YES;
+}
@@ -0,0 +1,31 @@
+#ifndef FIXEDCATS_DOT_H
+#define FIXEDCATS_DOT_H
+
+#include "universe.h"
+
+#define MAX_CATALYST_SIZE 16
+#define MAX_CATALYST_ON_CELLS 64
+
+// One orientation of a library catalyst, as row masks over its bounding box
+// (bit x of row y is cell (x, y) of the box). The mask codes are the same as
+// in the fixed catalyst tables:
+// on_bits       = 1: the catalyst's own cells, set to On when placed
+// off_bits      = 4: cells around it, set to Off when placed
+// must_off_bits = 2: cells that must already be Off
+
+typedef struct {
+	char name [32];
+	int wd, ht;
+	int n_on;
+	int on_x [MAX_CATALYST_ON_CELLS], on_y [MAX_CATALYST_ON_CELLS];
+	TILE_WORD on_bits [MAX_CATALYST_SIZE];
+	TILE_WORD off_bits [MAX_CATALYST_SIZE];
+	TILE_WORD must_off_bits [MAX_CATALYST_SIZE];
+} catalyst;
+
+int ver_cats (generation *ge);
+
+int load_catalyst_library (const char *filename, catalyst **cats);
+int catalyst_matches (const catalyst *c, const tile *t, int x, int y);
+
+#endif
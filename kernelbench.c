@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include "universe.h"
+
+// bellman_evolve is static in bellman.c and finds the previous generation of a tile through
+// u_evolving, so bellman.c is compiled into the benchmark, with its main out of the way
+#define main bellman_main
+#include "bellman.c"
+#undef main
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+// Microbenchmark of the tile kernels in evolve_bitwise.c, and a check of their results
+// against tile_evolve_simple.
+//
+// kernelbench [iterations]
+//
+// Each kernel is timed on a few kinds of tiles, alone or with all 8 neighbours, in ns per
+// tile and in rows per cycle. For bellman_evolve, the tiles have a static universe of still
+// lifes under them, with the search area of the kind, and their previous generation is the
+// static pattern, as in generation 0 of a search.
+
+#define N_SAMPLES 16
+#define N_COMPLETIONS 8
+#define DEFAULT_ITERATIONS 20000
+
+// A tile in the middle of 3 x 3 tiles, which are all linked up as in a universe. The tiles
+// are generation 1 of a contiguous universe u, and stable is their static universe.
+typedef struct {
+	tile gens [2] [9];
+	tile stable [9];
+	universe u;
+	tile out;
+} sample;
+
+#define CENTER(s) (&(s)->gens [1] [4])
+
+typedef struct {
+	const char *name;
+	int sparse;
+	int unknowns;
+	int neighbours;
+} tile_kind;
+
+static const tile_kind kinds [] = {
+	{"random", NO, NO, NO},
+	{"random+nb", NO, NO, YES},
+	{"sparse", YES, NO, NO},
+	{"sparse+nb", YES, NO, YES},
+	{"random+unk", NO, YES, NO},
+	{"random+unk+nb", NO, YES, YES},
+	{"sparse+unk", YES, YES, NO},
+	{"sparse+unk+nb", YES, YES, YES}
+};
+
+#define N_KINDS ((int) (sizeof kinds / sizeof kinds [0]))
+
+typedef struct {
+	const char *name;
+	evolve_func *func;
+	int three_state;
+} kernel;
+
+static const kernel kernels [] = {
+	{"tile_evolve_simple", tile_evolve_simple, NO},
+	{"tile_evolve_bitwise", tile_evolve_bitwise, NO},
+	{"tile_evolve_bitwise_3state", tile_evolve_bitwise_3state, YES},
+	{"tile_stabilise_3state", tile_stabilise_3state, YES},
+	{"bellman_evolve", bellman_evolve, YES}
+};
+
+#define N_KERNELS ((int) (sizeof kernels / sizeof kernels [0]))
+
+// Keeps the compiler from dropping the timed calls
+static volatile evolve_result sink;
+
+static uint64_t rng_state = 0x853c49e6748fea9b;
+
+static uint64_t rng ()
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return rng_state;
+}
+
+static uint64_t cycles ()
+{
+#ifdef HAVE_RDTSC
+	return __rdtsc ();
+#else
+	return 0;
+#endif
+}
+
+// Small still lifes, as rows of up to 4 cells, for the sparse catalyst-like tiles
+static const char *const still_lifes [] [4] = {
+	{"**", "**", NULL, NULL},
+	{".**.", "*..*", ".**.", NULL},
+	{"**.", "*.*", ".*.", NULL},
+	{".*.", "*.*", ".*.", NULL},
+	{"**..", "*.*.", "..*.", "..**"},
+	{".**.", "*..*", ".*.*", "..*."}
+};
+
+#define N_STILL_LIFES ((int) (sizeof still_lifes / sizeof still_lifes [0]))
+
+static void fill_tile (tile *t, const tile_kind *k)
+{
+	int x, y, i;
+
+	memset (t->bit0, 0, sizeof t->bit0);
+	memset (t->bit1, 0, sizeof t->bit1);
+
+	if (!k->sparse)
+		for (y = 0; y < TILE_HEIGHT; y++)
+			t->bit0 [y] = (TILE_WORD) rng ();
+	else
+		for (i = 0; i < 8; i++)
+		{
+			const char *const *p = still_lifes [rng () % N_STILL_LIFES];
+			int px = (int) (rng () % (TILE_WIDTH - 4)), py = (int) (rng () % (TILE_HEIGHT - 4));
+
+			for (y = 0; y < 4 && p [y]; y++)
+				for (x = 0; p [y] [x]; x++)
+					if (p [y] [x] == '*')
+						t->bit0 [py + y] |= ((TILE_WORD) 1) << (px + x);
+		}
+
+	// The search area of an input is a rectangle of unknown cells
+	if (k->unknowns)
+	{
+		int left = (int) (rng () % (TILE_WIDTH / 2)), top = (int) (rng () % (TILE_HEIGHT / 2));
+		int wd = 8 + (int) (rng () % (TILE_WIDTH / 2 - 8)), ht = 8 + (int) (rng () % (TILE_HEIGHT / 2 - 8));
+		TILE_WORD mask = ((((TILE_WORD) 1) << wd) - 1) << left;
+
+		for (y = top; y < top + ht; y++)
+		{
+			t->bit0 [y] |= mask;
+			t->bit1 [y] |= mask;
+		}
+	}
+}
+
+// Without neighbours, the middle tile stands alone
+static void link_tiles (tile *tiles, int neighbours)
+{
+	int i, gx, gy;
+
+	for (i = 0; i < 9; i++)
+	{
+		tile *t = &tiles [i];
+		gx = i % 3;
+		gy = i / 3;
+
+		t->xpos = (gx - 1) * TILE_WIDTH;
+		t->ypos = (gy - 1) * TILE_HEIGHT;
+
+		if (neighbours)
+		{
+			t->left = gx > 0 ? &tiles [i - 1] : NULL;
+			t->right = gx < 2 ? &tiles [i + 1] : NULL;
+			t->up = gy > 0 ? &tiles [i - 3] : NULL;
+			t->down = gy < 2 ? &tiles [i + 3] : NULL;
+		}
+	}
+}
+
+static void make_sample (sample *s, const tile_kind *k)
+{
+	tile_kind static_kind = {"static", YES, k->unknowns, k->neighbours};
+	int i;
+
+	for (i = 0; i < 9; i++)
+		free (s->stable [i].stable_words);
+	memset (s, 0, sizeof *s);
+
+	link_tiles (s->gens [0], k->neighbours);
+	link_tiles (s->gens [1], k->neighbours);
+	link_tiles (s->stable, k->neighbours);
+
+	for (i = 0; i < 9; i++)
+		if (i == 4 || k->neighbours)
+			fill_tile (&s->gens [1] [i], k);
+
+	for (i = 0; i < 9; i++)
+	{
+		if (i == 4 || k->neighbours)
+		{
+			fill_tile (&s->stable [i], &static_kind);
+			memcpy (s->gens [0] [i].bit0, s->stable [i].bit0, sizeof s->stable [i].bit0);
+			memcpy (s->gens [0] [i].bit1, s->stable [i].bit1, sizeof s->stable [i].bit1);
+		}
+		s->gens [0] [i].auxdata = s->gens [1] [i].auxdata = &s->stable [i];
+	}
+
+	s->u.tiles = s->gens [0];
+	s->u.ntiles = 9;
+}
+
+// A copy of the sample with every unknown cell set to On or Off at random
+static void complete_sample (const sample *s, sample *c)
+{
+	int i, y;
+
+	*c = *s;
+	for (i = 0; i < 9; i++)
+	{
+		tile *t = &c->gens [1] [i];
+		const tile *st = &s->gens [1] [i];
+
+		t->left = st->left ? t + (st->left - st) : NULL;
+		t->right = st->right ? t + (st->right - st) : NULL;
+		t->up = st->up ? t + (st->up - st) : NULL;
+		t->down = st->down ? t + (st->down - st) : NULL;
+
+		for (y = 0; y < TILE_HEIGHT; y++)
+		{
+			TILE_WORD unk = t->bit1 [y];
+			t->bit0 [y] = (t->bit0 [y] & ~unk) | ((TILE_WORD) rng () & unk);
+			t->bit1 [y] = 0;
+		}
+	}
+}
+
+static int tiles_differ (const tile *a, const tile *b)
+{
+	return memcmp (a->bit0, b->bit0, sizeof a->bit0) != 0 || memcmp (a->bit1, b->bit1, sizeof a->bit1) != 0;
+}
+
+// Returns the number of cells where the kernel disagrees with tile_evolve_simple
+static int check_kernel (const kernel *kn, sample *s, int unknowns)
+{
+	static sample c;
+	static tile ref;
+	tile *t = CENTER (s);
+	int errors = 0;
+	int i, y;
+
+	if (kn->func == bellman_evolve)
+	{
+		// Each cell is the 3-state evolution, or where its neighbourhood is the same as in the
+		// static universe, the static cell
+		tile *st = (tile *) t->auxdata;
+
+		tile_evolve_bitwise_3state (t, &ref);
+		u_evolving = &s->u;
+		bellman_evolve (t, &s->out);
+
+		for (y = 0; y < TILE_HEIGHT; y++)
+			errors += __builtin_popcountll ((uint64_t) (((s->out.bit0 [y] ^ ref.bit0 [y]) | (s->out.bit1 [y] ^ ref.bit1 [y]))
+				& ((s->out.bit0 [y] ^ st->bit0 [y]) | (s->out.bit1 [y] ^ st->bit1 [y]))));
+
+		return errors;
+	}
+
+	if (!unknowns)
+	{
+		tile_evolve_simple (t, &ref);
+		memset (&s->out, 0, sizeof s->out);
+		evolve_result flags = kn->func (t, &s->out);
+
+		if (kn->func == tile_stabilise_3state)
+		{
+			// A known tile only passes if it is stable, and then it stays the same
+			int stable = !tiles_differ (&ref, t);
+			if (stable != !(flags & ABORT))
+				errors++;
+			if (stable && tiles_differ (&s->out, t))
+				errors++;
+		}
+		else
+			for (y = 0; y < TILE_HEIGHT; y++)
+				errors += __builtin_popcountll ((uint64_t) ((s->out.bit0 [y] ^ ref.bit0 [y]) | s->out.bit1 [y]));
+
+		return errors;
+	}
+
+	if (kn->func != tile_evolve_bitwise_3state)
+		return 0;
+
+	// The known cells of the result must be the same in every completion of the unknown cells
+	memset (&s->out, 0, sizeof s->out);
+	kn->func (t, &s->out);
+
+	for (i = 0; i < N_COMPLETIONS; i++)
+	{
+		complete_sample (s, &c);
+		tile_evolve_simple (CENTER (&c), &ref);
+
+		for (y = 0; y < TILE_HEIGHT; y++)
+			errors += __builtin_popcountll ((uint64_t) ((s->out.bit0 [y] ^ ref.bit0 [y]) & ~s->out.bit1 [y]));
+	}
+
+	return errors;
+}
+
+int main (int argc, char *argv [])
+{
+	static sample samples [N_SAMPLES];
+	int iterations = (argc > 1) ? atoi (argv [1]) : DEFAULT_ITERATIONS;
+	int failed = NO;
+	int k, n, i;
+
+	if (iterations < 1)
+	{
+		fprintf (stderr, "Usage: %s [iterations]\n", argv [0]);
+		return -1;
+	}
+
+	printf ("Tile size %d x %d, %d samples of each kind, %d iterations\n", TILE_WIDTH, TILE_HEIGHT, N_SAMPLES, iterations);
+#ifndef HAVE_RDTSC
+	printf ("No cycle counter on this machine, rows/cycle is not measured\n");
+#endif
+	printf ("%-28s %-14s %10s %12s %8s\n", "kernel", "tiles", "ns/tile", "rows/cycle", "check");
+
+	for (k = 0; k < N_KINDS; k++)
+	{
+		const tile_kind *kd = &kinds [k];
+
+		for (i = 0; i < N_SAMPLES; i++)
+			make_sample (&samples [i], kd);
+
+		for (n = 0; n < N_KERNELS; n++)
+		{
+			const kernel *kn = &kernels [n];
+
+			// The 2-state kernels don't know about unknown cells
+			if (kd->unknowns && !kn->three_state)
+				continue;
+
+			int errors = 0;
+			for (i = 0; i < N_SAMPLES; i++)
+				errors += check_kernel (kn, &samples [i], kd->unknowns);
+
+			// tile_evolve_simple is only there for comparison, and slow
+			int runs = (kn->func == tile_evolve_simple) ? (iterations + 99) / 100 : iterations;
+
+			uint64_t ns = clock_ns (), cy = cycles ();
+			for (i = 0; i < runs; i++)
+			{
+				sample *s = &samples [i % N_SAMPLES];
+				u_evolving = &s->u;
+				sink ^= kn->func (CENTER (s), &s->out);
+			}
+			ns = clock_ns () - ns;
+			cy = cycles () - cy;
+
+			const char *check = "ok";
+			if (kd->unknowns && kn->func != tile_evolve_bitwise_3state && kn->func != bellman_evolve)
+				check = "-";
+			else if (errors)
+			{
+				check = "FAILED";
+				failed = YES;
+			}
+
+			printf ("%-28s %-14s %10.1f", kn->name, kd->name, (double) ns / runs);
+			if (cy)
+				printf (" %12.3f", (double) runs * TILE_HEIGHT / (double) cy);
+			else
+				printf (" %12s", "-");
+			printf (" %8s\n", check);
+			if (errors)
+				printf ("    %d cells differ from tile_evolve_simple\n", errors);
+		}
+	}
+
+	return failed ? 1 : 0;
+}
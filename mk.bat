@@ -1 +1 @@
-gcc.exe -o bellman.exe bellman.c evolve_bitwise.c lib.c readfile.c textconv.c universe.c writefile.c -O3 -Wall -Wextra -fno-stack-protector -march=native -Werror -fmax-errors=2
+gcc.exe -o bellman.exe bellman.c evolve_bitwise.c fixedcats.c lib.c readfile.c textconv.c universe.c writefile.c -O3 -Wall -Wextra -fno-stack-protector -march=native -pthread -Werror -fmax-errors=2
@@ -0,0 +1 @@
+gcc.exe extractresults.c -o extractresults.exe -O2 -Wall -Wextra
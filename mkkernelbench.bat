@@ -0,0 +1 @@
+gcc.exe kernelbench.c evolve_bitwise.c evolve_simple.c fixedcats.c lib.c readfile.c textconv.c universe.c writefile.c -o kernelbench.exe -O3 -march=native -Wall -Wextra -pthread
@@ -5,87 +5,130 @@
 #include "readwrite.h"
 
 
+typedef struct {
+        void (*cb)(void *, char, int, int, int, char);
+        void (*paramcb)(void *, const char *, const char *);
+        void *cbdata;
+        int gen, xpos, ypos;
+        char area;
+} life105_reader;
+
+static int read_life105_line(life105_reader *r, char *linebuff) {
+        char parambuff[63 + 1];
+        char valuebuff[63 + 1];
+
+        char *p = strchr(linebuff, '\r');
+        if(p) *p = 0;
+        p = strchr(linebuff, '\n');
+        if(p) *p = 0;
+
+        if(linebuff[0] == '#') switch(linebuff[1]) {
+                
+        case 'L':
+                // version header; ignore
+                break;
+
+        case 'D': 
+                // description; ignore
+                break;
+
+        case 'C': 
+                // comment; ignore
+                break;
+
+        case 'N':
+                // use normal Life rules
+                break;
+
+        case 'P':
+                // set co-ordinates
+                r->area = 'P';
+                r->gen = 0;
+                if(sscanf(linebuff + 2, "%d %d", &r->xpos, &r->ypos) != 2) {
+                        fprintf(stderr, "Bad pattern header: '%s'\n", linebuff);
+                        return 0;
+                }
+                break;
+
+        case 'F':
+                // set co-ordinates
+                r->area = 'F';
+                if(sscanf(linebuff + 2, "%d %d %d", &r->gen, &r->xpos, &r->ypos) != 3) {
+                        fprintf(stderr, "Bad filter header: '%s'\n", linebuff);
+                        return 0;
+                }
+                break;
+
+        case 'S':
+                // search space control parameter
+                if(sscanf(linebuff + 2, "%63s %63s", parambuff, valuebuff) != 2) {
+                        fprintf(stderr, "Bad search parameter line: '%s'\n", linebuff);
+                        return 0;
+                }
+                if(r->paramcb)
+                        r->paramcb(r->cbdata, parambuff, valuebuff);
+                break;
+
+        default:
+                fprintf(stderr, "--- Unknown line: '%s'\n", linebuff);
+                break;
+
+        } else {
+                // Process as data.
+                int x = r->xpos;
+
+                for(p = linebuff; *p; p++) {
+                        r->cb(r->cbdata, r->area, r->gen, x, r->ypos, *p);
+                        x++;
+                }
+                r->ypos++;
+        }
+
+        return 1;
+}
+
 int read_life105(FILE *f, 
                  void (*cb)(void *, char, int, int, int, char), 
                  void (*paramcb)(void *, const char *, const char *),
                  void *cbdata) {
 
         char linebuff[10000];        
-        char parambuff[63 + 1];
-        char valuebuff[63 + 1];
-        int gen, xpos, ypos;
-        char area = 'P';
+        life105_reader r = {cb, paramcb, cbdata, 0, 0, 0, 'P'};
 
         while(fgets(linebuff, sizeof linebuff, f)) {
-                char *p = strchr(linebuff, '\r');
-                if(p) *p = 0;
-                p = strchr(linebuff, '\n');
-                if(p) *p = 0;
-
-                if(linebuff[0] == '#') switch(linebuff[1]) {
-                        
-                case 'L':
-                        // version header; ignore
-                        break;
-
-                case 'D': 
-                        // description; ignore
-                        break;
-
-                case 'C': 
-                        // comment; ignore
-                        break;
-
-                case 'N':
-                        // use normal Life rules
-                        break;
-
-                case 'P':
-                        // set co-ordinates
-                        area = 'P';
-                        gen = 0;
-                        if(sscanf(linebuff + 2, "%d %d", &xpos, &ypos) != 2) {
-                                fprintf(stderr, "Bad pattern header: '%s'\n", linebuff);
-                                return 0;
-                        }
-                        break;
-
-                case 'F':
-                        // set co-ordinates
-                        area = 'F';
-                        if(sscanf(linebuff + 2, "%d %d %d", &gen, &xpos, &ypos) != 3) {
-                                fprintf(stderr, "Bad filter header: '%s'\n", linebuff);
-                                return 0;
-                        }
-                        break;
+                if(!read_life105_line(&r, linebuff))
+                        return 0;
+        }
+		
+		return 1;
+}
 
-                case 'S':
-                        // search space control parameter
-                        if(sscanf(linebuff + 2, "%63s %63s", parambuff, valuebuff) != 2) {
-                                fprintf(stderr, "Bad search parameter line: '%s'\n", linebuff);
-                                return 0;
-                        }
-                        if(paramcb)
-                                paramcb(cbdata, parambuff, valuebuff);
-                        break;
+// The same for Life 1.05 text in memory, such as a record of a results stream
+int read_life105_text(const char *text, size_t len,
+                      void (*cb)(void *, char, int, int, int, char), 
+                      void (*paramcb)(void *, const char *, const char *),
+                      void *cbdata) {
 
-                default:
-                        fprintf(stderr, "--- Unknown line: '%s'\n", linebuff);
-                        break;
+        char linebuff[10000];        
+        life105_reader r = {cb, paramcb, cbdata, 0, 0, 0, 'P'};
+        size_t pos = 0;
 
-                } else {
-                        // Process as data.
-                        int x = xpos;
+        while(pos < len) {
+                size_t n = 0;
 
-                        for(p = linebuff; *p; p++) {
-                                cb(cbdata, area, gen, x, ypos, *p);
-                                x++;
-                        }
-                        ypos++;
+                while(pos < len && text[pos] != '\n') {
+                        if(n < sizeof linebuff - 1)
+                                linebuff[n++] = text[pos];
+                        pos++;
                 }
+                pos++;
+                linebuff[n] = 0;
+
+                if(!read_life105_line(&r, linebuff))
+                        return 0;
         }
-		
-		return 1;
+
+        return 1;
 }
 
 static void life105cb(void *u_, char area, int gen, int x, int y, char c) {
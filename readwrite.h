@@ -6,6 +6,11 @@ int read_life105(FILE *f,
                  void (*paramcb)(void *, const char *, const char *),
                  void *cbdata);
 
+int read_life105_text(const char *text, size_t len,
+                      void (*cb)(void *, char, int, int, int, char), 
+                      void (*paramcb)(void *, const char *, const char *),
+                      void *cbdata);
+
 void write_life105(FILE *f, generation *g);
 void write_life105_text(FILE *f, generation *g);
 
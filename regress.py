@@ -0,0 +1,210 @@
+# Regression check of the solutions that bellman finds.
+#
+# Runs bellman on each input for a fixed number of search nodes, and compares the set of
+# solutions, their glider counts and the final prune counters with the golden outputs in
+# inputs/golden. A change that should only make bellman faster must not add or lose any
+# solution, and with the same search order it also leaves the prune counters as they were.
+#
+# python regress.py [-b bellman] [-n node-budget] [--update] [input ...]
+#
+# Without inputs, all inputs in the inputs directory are used. With --update, the golden
+# outputs are written instead of checked. The node budget of a golden output is stored with
+# it, and used for the check.
+#
+# Each result file is made canonical by dropping its #C and #S comment lines, which hold the
+# version and the search parameters. The rest is the pattern, at the position where it was
+# found, and is the same whatever the order of the search. The classify (-c) hash of the
+# result is shown next to each added or lost solution.
+#
+# Only test2.in, glider_test.txt and szlim_test.txt find solutions within the node budget.
+# H.in, H1.in, H2.in, H3.in, snark.in and the other test*.in are larger searches, which find
+# none in 6 million nodes either. Their golden outputs come from a search to the end with
+# max-live 4, which takes seconds, and in which H.in, H1.in, H2.in and snark.in find solutions.
+# H3.in, test.in, test1.in, test3.in and test4.in find none even then, so for them only the
+# prune counters are checked, and that no solution is added; the check marks them "counters
+# only". The parameters that an input is run with are stored with its golden output.
+
+import sys, os, glob, json, hashlib, subprocess, shutil, tempfile, argparse
+
+HERE = os.path.dirname (os.path.abspath (__file__))
+GOLDEN_DIR = os.path.join (HERE, "inputs", "golden")
+
+# Fields of the final --stats-file record that depend on the machine or the time
+UNSTABLE_FIELDS = ("time", "elapsed", "average_prunes_per_sec", "current_prunes_per_sec", "peak_memory_kb", "worker_gen", "current_single_gen")
+
+# Inputs that are searched to the end with these parameters, instead of their own
+SMALL_SEARCH_INPUTS = ("H.in", "H1.in", "H2.in", "H3.in", "snark.in", "test.in", "test1.in", "test3.in", "test4.in")
+SMALL_SEARCH_PARAMS = {"max-live": "4"}
+
+def default_inputs ():
+	files = sorted (glob.glob (os.path.join (HERE, "inputs", "*.in")))
+	files += sorted (glob.glob (os.path.join (HERE, "inputs", "*_test.txt")))
+	return files
+
+def golden_file (infile):
+	return os.path.join (GOLDEN_DIR, os.path.basename (infile) + ".json")
+
+def canonical_key (result_file):
+	with open (result_file) as f:
+		lines = [ln.rstrip () for ln in f if not ln.startswith ("#C") and not ln.startswith ("#S")]
+	while lines and not lines [-1]:
+		lines.pop ()
+	return hashlib.sha1 ("\n".join (lines).encode ()).hexdigest ()
+
+def header_value (result_file, prefix):
+	with open (result_file) as f:
+		for ln in f:
+			if ln.startswith (prefix):
+				return int (ln [len (prefix):])
+	return -1
+
+def accept_gen (result_file):
+	return header_value (result_file, "#C Solution accepted at generation ")
+
+# Gliders that escaped before the accept are counted too, so a miscount shows here
+def glider_count (result_file):
+	return header_value (result_file, "#C Glider count at accept ")
+
+# One bellman -c for all result files, which prints a hash for each of them in order
+def classify_hashes (bellman, result_files):
+	if not result_files:
+		return []
+	p = subprocess.run ([bellman, "-c"] + result_files, stdout = subprocess.PIPE, stderr = subprocess.DEVNULL)
+	hashes = [ln [6:] for ln in p.stdout.decode ().splitlines () if ln.startswith ("hash: ")]
+	return hashes if len (hashes) == len (result_files) else [None] * len (result_files)
+
+# A copy of the input in workdir, with the #S lines of params replaced, or added in front
+def input_with_params (infile, params, workdir):
+	with open (infile) as f:
+		lines = f.readlines ()
+	for name, value in sorted (params.items ()):
+		line = "#S %s %s\n" % (name, value)
+		found = [i for i, ln in enumerate (lines) if ln.split () [:2] == ["#S", name]]
+		for i in found:
+			lines [i] = line
+		if not found:
+			lines.insert (0, line)
+	copy = os.path.join (workdir, "input-" + os.path.basename (infile))
+	with open (copy, "w") as f:
+		f.writelines (lines)
+	return copy
+
+def run_input (bellman, infile, node_budget, params):
+	# Each run gets its own directory, for its result files
+	workdir = tempfile.mkdtemp (prefix = "regress-")
+	stats_file = os.path.join (workdir, "stats.json")
+	try:
+		args = [bellman, "--stats-file", stats_file]
+		if node_budget > 0:
+			args += ["--node-budget", str (node_budget)]
+		args.append (input_with_params (infile, params, workdir) if params else infile)
+		subprocess.run (args, cwd = workdir, stdout = subprocess.DEVNULL, stderr = subprocess.DEVNULL)
+
+		counters = None
+		with open (stats_file) as f:
+			for ln in f:
+				record = json.loads (ln)
+				if record.get ("final"):
+					counters = record
+		if counters is None:
+			raise ValueError ("no final stats record")
+		for field in UNSTABLE_FIELDS + ("final",):
+			counters.pop (field, None)
+
+		solutions = {}
+		results = sorted (glob.glob (os.path.join (workdir, "result*.out")))
+		for r, h in zip (results, classify_hashes (bellman, results)):
+			solutions [canonical_key (r)] = {
+				"file": os.path.basename (r),
+				"accept_gen": accept_gen (r),
+				"glider_count": glider_count (r),
+				"classify": h
+			}
+
+		return {"input": os.path.basename (infile), "node_budget": node_budget, "params": params, "counters": counters, "solutions": solutions}
+	except (OSError, ValueError) as e:
+		print ("%s: no output (%s)" % (infile, e), file = sys.stderr)
+		return None
+	finally:
+		shutil.rmtree (workdir, ignore_errors = True)
+
+def describe (key, sol):
+	return "%s (accepted at generation %d, classify hash %s, key %s)" % (sol ["file"], sol ["accept_gen"], sol ["classify"], key [:12])
+
+# Returns the number of differences, after printing them
+def compare (golden, run):
+	diffs = 0
+	for key in sorted (set (golden ["solutions"]) & set (run ["solutions"])):
+		gg, rg = golden ["solutions"] [key] ["glider_count"], run ["solutions"] [key] ["glider_count"]
+		if gg != rg:
+			print ("  gliders %d, was %d: %s" % (rg, gg, describe (key, run ["solutions"] [key])))
+			diffs += 1
+	for key in sorted (set (golden ["solutions"]) - set (run ["solutions"])):
+		print ("  lost:  " + describe (key, golden ["solutions"] [key]))
+		diffs += 1
+	for key in sorted (set (run ["solutions"]) - set (golden ["solutions"])):
+		print ("  added: " + describe (key, run ["solutions"] [key]))
+		diffs += 1
+
+	gc, rc = golden ["counters"], run ["counters"]
+	for name in sorted (set (gc) | set (rc)):
+		if gc.get (name) != rc.get (name):
+			print ("  %s: %s, was %s" % (name, rc.get (name, "-"), gc.get (name, "-")))
+			diffs += 1
+	return diffs
+
+def main ():
+	exe = "bellman.exe" if os.name == "nt" else "./bellman"
+	parser = argparse.ArgumentParser (description = "Check the solutions of bellman against the golden outputs")
+	parser.add_argument ("-b", "--bellman", default = exe, help = "bellman executable (default %s)" % exe)
+	parser.add_argument ("-n", "--node-budget", type = int, help = "search nodes per input for --update, 0 to search to the end (default 200000, or 0 for the inputs searched with max-live 4)")
+	parser.add_argument ("--update", action = "store_true", help = "write the golden outputs instead of checking them")
+	parser.add_argument ("inputs", nargs = "*")
+	args = parser.parse_args ()
+
+	bellman = os.path.abspath (args.bellman)
+	inputs = [os.path.abspath (i) for i in args.inputs] or default_inputs ()
+
+	failed = 0
+	for infile in inputs:
+		name = os.path.basename (infile)
+
+		if args.update:
+			small = name in SMALL_SEARCH_INPUTS
+			node_budget = args.node_budget if args.node_budget is not None else 0 if small else 200000
+			run = run_input (bellman, infile, node_budget, SMALL_SEARCH_PARAMS if small else {})
+			if not run:
+				failed += 1
+				continue
+			os.makedirs (GOLDEN_DIR, exist_ok = True)
+			with open (golden_file (infile), "w") as f:
+				json.dump (run, f, indent = 1, sort_keys = True)
+			print ("%-16s %5d solutions, %d prunes, written" % (name, len (run ["solutions"]), run ["counters"] ["total_prunes"]))
+			continue
+
+		try:
+			with open (golden_file (infile)) as f:
+				golden = json.load (f)
+		except (OSError, ValueError) as e:
+			print ("%-16s no golden output (%s)" % (name, e))
+			failed += 1
+			continue
+
+		run = run_input (bellman, infile, golden ["node_budget"], golden.get ("params", {}))
+		if not run:
+			failed += 1
+			continue
+
+		print ("%-16s %5d solutions, %d prunes%s" % (name, len (run ["solutions"]), run ["counters"] ["total_prunes"], "" if golden ["solutions"] else ", counters only"))
+		if compare (golden, run):
+			print ("%-16s DIFFERS" % name)
+			failed += 1
+
+	if args.update:
+		return 1 if failed else 0
+
+	print ("All %d inputs same as the golden outputs" % len (inputs) if not failed else "%d of %d inputs differ" % (failed, len (inputs)))
+	return 1 if failed else 0
+
+if __name__ == "__main__":
+	sys.exit (main ())
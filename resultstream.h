@@ -0,0 +1,50 @@
+#ifndef RESULTSTREAM_DOT_H
+#define RESULTSTREAM_DOT_H
+
+#include <stdint.h>
+
+// Index entry of a results stream written by bellman -o or -b. The index file has one entry per
+// solution, in the byte order of the machine that wrote it. The record of a solution, without
+// the lines at the start of the stream, is length bytes at offset in the stream.
+
+#define RESULT_FORMAT_TEXT 0
+#define RESULT_FORMAT_COMPACT 1
+
+typedef struct {
+	uint32_t id;
+	uint32_t length;
+	uint64_t offset;
+	int32_t accept_gen;
+	int32_t glider_count;
+	int32_t max_active;
+	int32_t format;
+} result_index_entry;
+
+// A RESULT_FORMAT_COMPACT record is a compact_result_header followed by n_tiles tiles.
+// Each tile is a compact_tile_header and the cells of its bounding box, 2 bits per cell,
+// row by row, starting with the low bits of the first byte, padded to a whole byte.
+// A tile without any cells has width and height 0.
+
+#define COMPACT_CELL_OFF 0
+#define COMPACT_CELL_ON 1
+#define COMPACT_CELL_ACTIVE 2
+#define COMPACT_CELL_UNKNOWN 3
+
+#define COMPACT_MAX_ACTIVATIONS 32
+
+typedef struct {
+	int32_t accept_gen;
+	int32_t max_active;
+	int32_t glider_count;
+	int32_t act_count;
+	int32_t act_gen [COMPACT_MAX_ACTIVATIONS];
+	int32_t tile_width, tile_height;
+	int32_t n_tiles;
+} compact_result_header;
+
+typedef struct {
+	int32_t xpos, ypos;
+	int32_t left, top, width, height;
+} compact_tile_header;
+
+#endif
@@ -25,7 +25,20 @@ universe *universe_new(cellvalue def) {
 void universe_free(universe *u) {
         generation *g, *gn;
 
+        if(u->gens) {
+                free(u->tiles);
+                free(u->gens);
+                free(u);
+                return;
+        }
+
         for(g = u->first; g; g = gn) {
+                tile *t, *tn;
+                for(t = g->all_first; t; t = tn) {
+                        tn = t->all_next;
+                        free(t);
+                }
+
                 gn = g->next;
                 free(g);
         }
@@ -49,6 +62,9 @@ tile *generation_find_tile(generation *g, int xpos, int ypos, int create) {
 
         if(!create) return NULL;
 
+        // A contiguous universe has a tile at every position it covers
+        assert(!g->u->gens);
+
         t = (tile *)allocate(sizeof *t);
         t->xpos = tx;
         t->ypos = ty;
@@ -105,6 +121,11 @@ generation *universe_find_generation(universe *u, uint32_t gen, int create) {
 
         assert(u);
 
+        if(u->gens) {
+                assert(create == 0 || gen < u->n_gens);
+                return (gen < u->n_gens) ? &u->gens[gen] : NULL;
+        }
+
         if(create == 0) {
                 if(gen >= u->n_gens)
                         return NULL;
@@ -190,10 +211,88 @@ void universe_evolve_next(universe *u) {
         generation_evolve(g->prev, tile_evolve_bitwise_3state);
 }
 
+// Evolve a generation of a contiguous universe. The tiles of the next
+// generation are the ntiles tiles following this generation's row, and
+// neighbours always exist (or are off the edge of the universe), so
+// expanding just marks the neighbour as changed, widening the range of
+// used tiles if needed. A neighbour that we have already passed without
+// evolving it gets picked up by another sweep.
+static void generation_evolve_contiguous(generation *g, evolve_func *func) {
+        universe *u = g->u;
+        int ntiles = u->ntiles;
+        tile *row = g->tiles;
+        unsigned char evolved[ntiles];
+        int first = u->used_lo;
+        int i;
+
+        memset(evolved, 0, sizeof evolved);
+
+        while(first < u->used_hi) {
+                int rescan = u->used_hi;
+
+                for(i = first; i < u->used_hi; i++) {
+                        tile *t = row + i;
+                        if(evolved[i] || !(t->flags & CHANGED))
+                                continue;
+
+                        tile *out = t + ntiles;
+                        evolve_result res = func(t, out);
+                        out->flags = res;
+                        evolved[i] = 1;
+                        t->flags &= ~CHANGED;
+
+                        tile *nb[4] = { NULL, NULL, NULL, NULL };
+                        if(res & EXPAND_UP) nb[0] = t->up;
+                        if(res & EXPAND_DOWN) nb[1] = t->down;
+                        if(res & EXPAND_LEFT) nb[2] = t->left;
+                        if(res & EXPAND_RIGHT) nb[3] = t->right;
+
+                        int k;
+                        for(k=0; k<4; k++) {
+                                if(!nb[k]) continue;
+                                nb[k]->flags |= CHANGED;
+
+                                int j = nb[k] - row;
+                                if(j < u->used_lo) u->used_lo = j;
+                                if(j >= u->used_hi) u->used_hi = j + 1;
+                                if(j < i && !evolved[j] && j < rescan)
+                                        rescan = j;
+                        }
+                }
+
+                first = rescan;
+        }
+
+        evolve_result genflags = 0;
+        int n_active = 0;
+        int delta_prev = 0;
+        int first_unknown_tile = -1;
+
+        for(i = u->used_lo; i < u->used_hi; i++) {
+                tile *out = row + ntiles + i;
+                if((out->flags & HAS_UNKNOWN_CELLS) && first_unknown_tile < 0)
+                        first_unknown_tile = i;
+                genflags |= out->flags;
+                n_active += out->n_active;
+                delta_prev += out->delta_prev;
+        }
+
+        g->next->first_unknown_tile = first_unknown_tile;
+        g->next->flags = genflags;
+        g->next->n_active = n_active;
+        g->next->delta_prev = delta_prev;
+        g->flags &= ~CHANGED;
+}
+
 void generation_evolve(generation *g, evolve_func *func) {
 
         assert(g->next);
 
+        if(g->u->gens) {
+                generation_evolve_contiguous(g, func);
+                return;
+        }
+
         evolve_result genflags = 0;
         int n_active = 0;
         int delta_prev = 0;
@@ -336,6 +435,111 @@ universe *universe_copy(universe *from, int gen) {
         return u;
 }
 
+void universe_make_contiguous(universe *u, int left, int top, int right, int bottom) {
+        int tx0 = left - (((unsigned int)left) % TILE_WIDTH);
+        int ty0 = top - (((unsigned int)top) % TILE_HEIGHT);
+        int tx1 = right - (((unsigned int)right) % TILE_WIDTH);
+        int ty1 = bottom - (((unsigned int)bottom) % TILE_HEIGHT);
+        int w = ((tx1 - tx0) / TILE_WIDTH) + 1;
+        int h = ((ty1 - ty0) / TILE_HEIGHT) + 1;
+        int ntiles = w * h;
+        int n_gens = u->n_gens;
+
+        assert(!u->gens);
+
+        generation *gens = (generation *)allocate(n_gens * sizeof *gens);
+        tile *tiles = (tile *)allocate((size_t)n_gens * ntiles * sizeof *tiles);
+        if(!gens || !tiles) exit(-1);
+
+        generation *g, *gn;
+        int gi, i, y;
+        int used_lo = ntiles, used_hi = 0;
+
+        for(g = u->first, gi = 0; g; g = gn, gi++) {
+                generation *ng = &gens[gi];
+                int copied = 0;
+
+                ng->u = u;
+                ng->gen = g->gen;
+                ng->ntiles = ntiles;
+                ng->tiles = &tiles[gi * ntiles];
+                ng->prev = (gi > 0) ? &gens[gi - 1] : NULL;
+                ng->next = (gi < n_gens - 1) ? &gens[gi + 1] : NULL;
+                ng->flags = g->flags;
+                ng->n_active = g->n_active;
+                ng->delta_prev = g->delta_prev;
+                ng->all_first = &ng->tiles[0];
+                ng->all_last = &ng->tiles[ntiles - 1];
+                ng->first_unknown_tile = -1;
+
+                for(i=0; i<ntiles; i++) {
+                        tile *t = &ng->tiles[i];
+                        int col = i % w;
+
+                        t->xpos = tx0 + (col * TILE_WIDTH);
+                        t->ypos = ty0 + ((i / w) * TILE_HEIGHT);
+
+                        tile *old = generation_find_tile(g, t->xpos, t->ypos, 0);
+                        if(old) {
+                                memcpy(t->bit0, old->bit0, sizeof t->bit0);
+                                memcpy(t->bit1, old->bit1, sizeof t->bit1);
+                                t->auxdata = old->auxdata;
+                                t->flags = old->flags;
+                                t->n_active = old->n_active;
+                                t->delta_prev = old->delta_prev;
+                                t->text = old->text;
+                                t->filter = old->filter;
+                                t->unknown_rows = old->unknown_rows;
+                                copied++;
+                                if((t->flags & HAS_UNKNOWN_CELLS) && ng->first_unknown_tile < 0)
+                                        ng->first_unknown_tile = i;
+                                if(i < used_lo) used_lo = i;
+                                if(i >= used_hi) used_hi = i + 1;
+                        } else {
+                                for(y=0; y<TILE_HEIGHT; y++) {
+                                        t->bit0[y] = (u->def & 1) ? ~0 : 0;
+                                        t->bit1[y] = (u->def & 2) ? ~0 : 0;
+                                }
+                                if(gi > 0)
+                                        t->auxdata = (t - ntiles)->auxdata;
+                        }
+
+                        t->left = (col > 0) ? t - 1 : NULL;
+                        t->right = (col < w - 1) ? t + 1 : NULL;
+                        t->up = (i >= w) ? t - w : NULL;
+                        t->down = (i < ntiles - w) ? t + w : NULL;
+                        t->prev = (gi > 0) ? t - ntiles : NULL;
+                        t->next = (gi < n_gens - 1) ? t + ntiles : NULL;
+                        t->all_next = (i < ntiles - 1) ? t + 1 : NULL;
+
+                        uint32_t thash = poshash(t->xpos, t->ypos);
+                        t->hashnext = ng->xyhash[thash];
+                        ng->xyhash[thash] = t;
+                }
+
+                // Everything in the old generation must fit in the rectangle
+                assert(copied == g->ntiles);
+                (void)copied;
+
+                tile *t, *tn;
+                for(t = g->all_first; t; t = tn) {
+                        tn = t->all_next;
+                        free(t);
+                }
+
+                gn = g->next;
+                free(g);
+        }
+
+        u->first = &gens[0];
+        u->last = &gens[n_gens - 1];
+        u->gens = gens;
+        u->tiles = tiles;
+        u->ntiles = ntiles;
+        u->used_lo = used_lo;
+        u->used_hi = used_hi;
+}
+
 #define FLAG(name) do { \
                 if(flags & name) { \
                         flags &= ~name; \
@@ -366,6 +570,7 @@ const char *flag2str(evolve_result flags) {
         FLAG(IS_LIVE);
         FLAG(FILTER_MISMATCH);
 		FLAG(HAS_ON_CELLS);
+		FLAG(MAY_BE_ACTIVE);
 
         if(flags) {
                 p += sprintf(p, "%x?", flags);
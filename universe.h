@@ -49,7 +49,8 @@ enum {
         IS_LIVE = 0x8000,
 
         FILTER_MISMATCH = 0x10000,
-		HAS_ON_CELLS = 0x20000
+		HAS_ON_CELLS = 0x20000,
+		MAY_BE_ACTIVE = 0x40000
 
 };
 
@@ -67,6 +68,8 @@ struct tile_s {
         unsigned int delta_prev; // number of cells that differ from the previous generation
         char *text;
         tile *filter; // used by bellman
+        void *stable_words; // used by bellman
+        uint64_t unknown_rows; // bit y set if row y has UNKNOWN cells, used by bellman
 };
 
 #define HASH_SIZE 15
@@ -78,6 +81,9 @@ struct generation_s {
         generation *next, *prev;
         tile *xyhash[HASH_SIZE];
         tile *all_first, *all_last;
+        tile *tiles; // this generation's row of u->tiles, if contiguous
+        int first_unknown_tile; // index of the first tile with HAS_UNKNOWN_CELLS, or -1, if contiguous
+        int escaped_gliders; // gliders taken out of this generation and earlier ones, used by bellman
         evolve_result flags;
         unsigned int n_active; // number of cells that differ from the stable state
         unsigned int delta_prev; // number of cells that differ from the previous generation
@@ -87,6 +93,16 @@ struct universe_s {
         uint32_t n_gens;
         cellvalue def;
         generation *first, *last;
+
+        // Set by universe_make_contiguous: all generations live in
+        // gens[n_gens], and all their tiles in tiles[n_gens][ntiles],
+        // laid out row-major over the same tile-aligned rectangle.
+        generation *gens;
+        tile *tiles;
+        int ntiles;
+        // Tiles outside [used_lo, used_hi) are blank and have never
+        // been evolved in any generation, so they can be skipped.
+        int used_lo, used_hi;
 };
 
 universe *universe_new(cellvalue def);
@@ -94,6 +110,8 @@ void universe_free(universe *);
 
 universe *universe_copy(universe *from, int gen);
 
+void universe_make_contiguous(universe *u, int left, int top, int right, int bottom);
+
 generation *universe_find_generation(universe *u, uint32_t gen, int create);
 tile *generation_find_tile(generation *g, int xpos, int ypos, int create);
 